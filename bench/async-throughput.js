@@ -0,0 +1,76 @@
+//
+//   ----------------------------------------------------------------------------
+//   | Package:     mg-dbx                                                      |
+//   | OS:          Unix/Windows                                                |
+//   | Description: Throughput of asynchronous get() against the mock server    |
+//   ----------------------------------------------------------------------------
+//
+// Usage: node bench/async-throughput.js [requests] [in_flight] [runs]
+//
+// Issues asynchronous get() calls (with a callback) on one connection,
+// keeping in_flight of them outstanding, and reports requests per second for
+// each run.  The build measured is build/Release/mg-dbx.node unless
+// MG_DBX_NODE names another, so that two builds can be compared:
+//
+//   MG_DBX_NODE=/path/to/before/mg-dbx.node node bench/async-throughput.js
+//   MG_DBX_NODE=/path/to/after/mg-dbx.node node bench/async-throughput.js
+//
+
+"use strict";
+
+const harness = require('../test/harness.js');
+
+const REQUESTS = parseInt(process.argv[2] || '20000', 10);
+const IN_FLIGHT = parseInt(process.argv[3] || '64', 10);
+const RUNS = parseInt(process.argv[4] || '3', 10);
+
+function run(db) {
+   return new Promise((resolve, reject) => {
+      const start = process.hrtime.bigint();
+      let issued = 0, done = 0;
+
+      const next = () => {
+         issued ++;
+         db.get('Bench', issued % 100, (error, result) => {
+            if (error) {
+               return reject(new Error(result && result.ErrorMessage ? result.ErrorMessage : String(error)));
+            }
+            done ++;
+            if (done === REQUESTS) {
+               return resolve(Number(process.hrtime.bigint() - start) / 1e9);
+            }
+            if (issued < REQUESTS) {
+               next();
+            }
+         });
+      };
+
+      for (let n = 0; n < IN_FLIGHT && n < REQUESTS; n ++) {
+         next();
+      }
+   });
+}
+
+async function main() {
+   const con = await harness.connect();
+
+   try {
+      for (let n = 0; n < 100; n ++) {
+         con.db.set('Bench', n, 'value ' + n);
+      }
+      await run(con.db); // warm up
+      console.log('requests: ' + REQUESTS + ', in flight: ' + IN_FLIGHT);
+      for (let n = 0; n < RUNS; n ++) {
+         const seconds = await run(con.db);
+         console.log('run ' + (n + 1) + ': ' + Math.round(REQUESTS / seconds) + ' ops/s');
+      }
+   }
+   finally {
+      con.close();
+   }
+}
+
+main().catch((error) => {
+   console.error(error);
+   process.exit(1);
+});
@@ -0,0 +1,86 @@
+//
+//   ----------------------------------------------------------------------------
+//   | Package:     mg-dbx                                                      |
+//   | OS:          Unix/Windows                                                |
+//   | Description: Throughput of several connections to one mock server        |
+//   ----------------------------------------------------------------------------
+//
+// Usage: node bench/connections.js [requests] [in_flight] [latency_ms]
+//
+// Opens 1, 2, 4 and 8 connections to one mock server that takes latency_ms
+// to answer each request, and shares requests asynchronous get() calls
+// between them, keeping in_flight outstanding on each connection.  With
+// one thread per connection, independent connections should scale
+// linearly.  MG_DBX_NODE selects the build to measure (see
+// async-throughput.js).
+//
+
+"use strict";
+
+const harness = require('../test/harness.js');
+const MockServer = require('../test/mock-dbx1.js');
+
+const REQUESTS = parseInt(process.argv[2] || '2000', 10);
+const IN_FLIGHT = parseInt(process.argv[3] || '16', 10);
+const LATENCY = parseInt(process.argv[4] || '1', 10);
+
+// resolve when each connection has completed its share of the requests
+function run(dbs) {
+   const share = Math.floor(REQUESTS / dbs.length);
+
+   return Promise.all(dbs.map((db) => new Promise((resolve, reject) => {
+      let issued = 0, done = 0;
+
+      const next = () => {
+         issued ++;
+         db.get('Bench', issued % 100, (error, result) => {
+            if (error) {
+               return reject(new Error(result && result.ErrorMessage ? result.ErrorMessage : String(error)));
+            }
+            done ++;
+            if (done === share) {
+               return resolve();
+            }
+            if (issued < share) {
+               next();
+            }
+         });
+      };
+
+      for (let n = 0; n < IN_FLIGHT && n < share; n ++) {
+         next();
+      }
+   })));
+}
+
+async function main() {
+   const mock = await MockServer.spawn({latency: LATENCY});
+
+   try {
+      console.log('requests: ' + REQUESTS + ', in flight per connection: ' + IN_FLIGHT + ', latency: ' + LATENCY + 'ms');
+      for (const connections of [1, 2, 4, 8]) {
+         const dbs = [];
+
+         for (let n = 0; n < connections; n ++) {
+            const db = new harness.dbx.dbx();
+            db.open({type: 'YottaDB', host: '127.0.0.1', tcp_port: mock.port});
+            dbs.push(db);
+         }
+         const start = process.hrtime.bigint();
+         await run(dbs);
+         const seconds = Number(process.hrtime.bigint() - start) / 1e9;
+         console.log('connections: ' + connections + ': ' + Math.round((Math.floor(REQUESTS / connections) * connections) / seconds) + ' ops/s');
+         for (const db of dbs) {
+            db.close();
+         }
+      }
+   }
+   finally {
+      mock.close();
+   }
+}
+
+main().catch((error) => {
+   console.error(error);
+   process.exit(1);
+});
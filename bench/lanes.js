@@ -0,0 +1,87 @@
+//
+//   ----------------------------------------------------------------------------
+//   | Package:     mg-dbx                                                      |
+//   | OS:          Unix/Windows                                                |
+//   | Description: Latency of short requests mixed with long running ones      |
+//   ----------------------------------------------------------------------------
+//
+// Usage: node bench/lanes.js [seconds] [functions] [gets] [function_ms]
+//
+// On one connection with a pool of 4 threads, runs closed loops of
+// asynchronous requests for the given time: functions loops calling a
+// function that takes function_ms to reply, and gets loops calling get().
+// Reports the latency percentiles of each kind of request in milliseconds.
+// MG_DBX_NODE selects the build to measure (see async-throughput.js).
+//
+
+"use strict";
+
+const harness = require('../test/harness.js');
+
+const SECONDS = parseFloat(process.argv[2] || '3');
+const FUNCTIONS = parseInt(process.argv[3] || '6', 10);
+const GETS = parseInt(process.argv[4] || '8', 10);
+const FUNCTION_MS = parseInt(process.argv[5] || '20', 10);
+
+function percentile(times, p) {
+   if (!times.length) {
+      return 0;
+   }
+   times.sort((a, b) => a - b);
+   return times[Math.min(times.length - 1, Math.floor(times.length * p / 100))];
+}
+
+// call request(callback) repeatedly until the deadline, recording the time taken by each
+function loop(request, deadline, times) {
+   return new Promise((resolve, reject) => {
+      const next = () => {
+         const start = process.hrtime.bigint();
+
+         request((error, result) => {
+            if (error) {
+               return reject(new Error(result && result.ErrorMessage ? result.ErrorMessage : String(error)));
+            }
+            times.push(Number(process.hrtime.bigint() - start) / 1e6);
+            if (Date.now() < deadline) {
+               next();
+            }
+            else {
+               resolve();
+            }
+         });
+      };
+      next();
+   });
+}
+
+async function main() {
+   const con = await harness.connect({pool_size: 4});
+
+   try {
+      const gets = [], functions = [];
+      const deadline = Date.now() + (SECONDS * 1000);
+      const loops = [];
+
+      con.db.set('Bench', 1, 'value');
+      for (let n = 0; n < FUNCTIONS; n ++) {
+         loops.push(loop((cb) => con.db.function('delay^mock', FUNCTION_MS, 'done', cb), deadline, functions));
+      }
+      for (let n = 0; n < GETS; n ++) {
+         loops.push(loop((cb) => con.db.get('Bench', 1, cb), deadline, gets));
+      }
+      await Promise.all(loops);
+
+      console.log(FUNCTIONS + ' functions of ' + FUNCTION_MS + 'ms and ' + GETS + ' gets for ' + SECONDS + 's (latency in ms)');
+      for (const [name, times] of [['get', gets], ['function', functions]]) {
+         console.log(name + ': requests ' + times.length + ', p50 ' + percentile(times, 50).toFixed(2) + ', p99 ' + percentile(times, 99).toFixed(2) + ', max ' + percentile(times, 100).toFixed(2));
+      }
+   }
+   finally {
+      con.close();
+   }
+}
+
+main().catch((error) => {
+   console.error(error);
+   process.exit(1);
+});
@@ -77,6 +77,15 @@ void mclass::Init(Handle<Object> exports)
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "reset", Reset);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "_close", Close);
 
+   /* v2.1.20 Promise-returning variants of the asynchronous methods */
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "classmethod", ClassMethod);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "classmethod_bx", ClassMethod_bx);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "method", Method);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "method_bx", Method_bx);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "setproperty", SetProperty);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "getproperty", GetProperty);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "getproperty_bx", GetProperty_bx);
+
 #if DBX_NODE_VERSION >= 120000
    constructor.Reset(isolate, tpl->GetFunction(icontext).ToLocalChecked());
    exports->Set(icontext, String::NewFromUtf8(isolate, "mclass", NewStringType::kNormal).ToLocalChecked(), tpl->GetFunction(icontext).ToLocalChecked()).FromJust();
@@ -269,14 +278,13 @@ void mclass::ClassMethodEx(const FunctionCallbackInfo<Value>& args, int binary)
       baton->clx = (void *) clx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_classmethod;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       clx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -302,7 +310,7 @@ void mclass::ClassMethodEx(const FunctionCallbackInfo<Value>& args, int binary)
 
    if (pmeth->output_val.type != DBX_DTYPE_OREF) {
       if (binary) {
-         Local<Object> bx = node::Buffer::New(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+         Local<Object> bx = dbx_new_buffer(isolate, pmeth);
          args.GetReturnValue().Set(bx);
       }
       else {
@@ -383,14 +391,13 @@ void mclass::MethodEx(const FunctionCallbackInfo<Value>& args, int binary)
       baton->clx = (void *) clx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_method;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       clx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -417,7 +424,7 @@ void mclass::MethodEx(const FunctionCallbackInfo<Value>& args, int binary)
 
    if (pmeth->output_val.type != DBX_DTYPE_OREF) {
       if (binary) {
-         Local<Object> bx = node::Buffer::New(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+         Local<Object> bx = dbx_new_buffer(isolate, pmeth);
          args.GetReturnValue().Set(bx);
       }
       else {
@@ -485,14 +492,13 @@ void mclass::SetProperty(const FunctionCallbackInfo<Value>& args)
       baton->clx = (void *) clx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_setproperty;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       clx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -581,14 +587,13 @@ void mclass::GetPropertyEx(const FunctionCallbackInfo<Value>& args, int binary)
       baton->clx = (void *) clx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_getproperty;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       clx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -614,7 +619,7 @@ void mclass::GetPropertyEx(const FunctionCallbackInfo<Value>& args, int binary)
 
    if (pmeth->output_val.type != DBX_DTYPE_OREF) {
       if (binary) {
-         Local<Object> bx = node::Buffer::New(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+         Local<Object> bx = dbx_new_buffer(isolate, pmeth);
          args.GetReturnValue().Set(bx);
       }
       else {
@@ -34,6 +34,7 @@ Persistent<Function> mcursor::constructor;
 
 mcursor::mcursor(int value) : dbx_count(value)
 {
+   dbx_cursor_init((void *) this); /* v2.1.20 */
 }
 
 
@@ -70,10 +71,17 @@ void mcursor::Init(Handle<Object> exports)
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "execute", Execute);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "cleanup", Cleanup);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "next", Next);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "nextBatch", NextBatch); /* v2.1.20 */
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "previous", Previous);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "reset", Reset);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "_close", Close);
 
+   /* v2.1.20 Promise-returning variants of the asynchronous methods */
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "execute", Execute);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "cleanup", Cleanup);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "next", Next);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "nextBatch", NextBatch);
+
 #if DBX_NODE_VERSION >= 120000
    constructor.Reset(isolate, tpl->GetFunction(icontext).ToLocalChecked());
    exports->Set(icontext, String::NewFromUtf8(isolate, "mcursor", NewStringType::kNormal).ToLocalChecked(), tpl->GetFunction(icontext).ToLocalChecked()).FromJust();
@@ -185,8 +193,45 @@ int mcursor::async_callback(mcursor *cx)
 }
 
 
+/* v2.1.20 release the cursor's key arenas and buffers */
 int mcursor::delete_mcursor_template(mcursor *cx)
 {
+   int cn;
+
+   for (cn = 0; cn < 2; cn ++) {
+      if (cx->ahead[cn].rec.buf_addr) {
+         dbx_free((void *) cx->ahead[cn].rec.buf_addr, 501);
+         cx->ahead[cn].rec.buf_addr = NULL;
+         cx->ahead[cn].rec.len_alloc = 0;
+      }
+   }
+   ahead_reset(cx);
+
+   if (cx->pqr_next) {
+      dbx_free_dbxqr(cx->pqr_next);
+      cx->pqr_next = NULL;
+   }
+   if (cx->pqr_prev) {
+      dbx_free_dbxqr(cx->pqr_prev);
+      cx->pqr_prev = NULL;
+   }
+   if (cx->data.buf_addr) {
+      dbx_free((void *) cx->data.buf_addr, 501);
+      cx->data.buf_addr = NULL;
+      cx->data.len_alloc = 0;
+      cx->data.len_used = 0;
+   }
+   if (cx->psql) {
+      for (cn = 0; cn < cx->psql->no_cols; cn ++) {
+         if (cx->psql->cols[cn]) {
+            dbx_free((void *) cx->psql->cols[cn], 701);
+            cx->psql->cols[cn] = NULL;
+         }
+      }
+      dbx_free((void *) cx->psql, 701);
+      cx->psql = NULL;
+   }
+
    return 0;
 }
 
@@ -220,6 +265,10 @@ void mcursor::Execute(const FunctionCallbackInfo<Value>& args)
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
+   if (ahead_busy(args, cx, pmeth, 0)) { /* v2.1.20 */
+      return;
+   }
+   ahead_reset(cx);
    
    DBX_DBFUN_START(c, pcon, pmeth);
 
@@ -228,9 +277,7 @@ void mcursor::Execute(const FunctionCallbackInfo<Value>& args)
       baton->cx = (void *) cx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_sql_execute;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
 
       cx->Ref();
 
@@ -239,7 +286,7 @@ void mcursor::Execute(const FunctionCallbackInfo<Value>& args)
 
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -311,6 +358,9 @@ void mcursor::Cleanup(const FunctionCallbackInfo<Value>& args)
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
+   if (ahead_busy(args, cx, pmeth, 0)) { /* v2.1.20 */
+      return;
+   }
    
    DBX_DBFUN_START(c, pcon, pmeth);
 
@@ -319,9 +369,7 @@ void mcursor::Cleanup(const FunctionCallbackInfo<Value>& args)
       baton->cx = (void *) cx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_sql_cleanup;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
 
       cx->Ref();
 
@@ -330,7 +378,7 @@ void mcursor::Cleanup(const FunctionCallbackInfo<Value>& args)
 
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -376,8 +424,23 @@ void mcursor::Next(const FunctionCallbackInfo<Value>& args)
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
-   if (async) {
-      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Cursor based operations cannot be invoked asynchronously", 1)));
+   if (async) { /* v2.1.20 */
+      ahead_request(args, isolate, cx, pmeth, 0);
+      return;
+   }
+
+   /* v2.1.20 return any records already read ahead by an asynchronous call */
+   if (ahead_busy(args, cx, pmeth, 0)) {
+      return;
+   }
+   if (cx->ahead[cx->ahead_cur].state == 2 || cx->ahead_eod) {
+      if (cx->ahead[cx->ahead_cur].state != 2 && cx->ahead_error[0]) {
+         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, cx->ahead_error, 1)));
+         cx->ahead_error[0] = '\0';
+      }
+      else {
+         args.GetReturnValue().Set(ahead_take(isolate, cx, 0));
+      }
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
@@ -563,6 +626,70 @@ void mcursor::Next(const FunctionCallbackInfo<Value>& args)
 }
 
 
+/* v2.1.20 return up to the requested number of records as an array */
+void mcursor::NextBatch(const FunctionCallbackInfo<Value>& args)
+{
+   short async;
+   int max;
+   DBXCON *pcon;
+   DBXMETH *pmeth;
+   mcursor *cx = ObjectWrap::Unwrap<mcursor>(args.This());
+   MG_CURSOR_CHECK_CLASS(cx);
+   DBX_DBNAME *c = cx->c;
+   DBX_GET_ICONTEXT;
+   cx->dbx_count ++;
+
+   pcon = c->pcon;
+   if (pcon->log_functions) {
+      c->LogFunction(c, args, (void *) cx, (char *) "mcursor::nextBatch");
+   }
+   pmeth = dbx_request_memory(pcon, 0);
+
+   DBX_CALLBACK_FUN(pmeth->argc, cb, async);
+
+   max = 0;
+   if (pmeth->argc == 1 && args[0]->IsNumber()) {
+      max = DBX_INT32_VALUE(args[0]);
+   }
+   if (max < 1 || max > DBX_CURSOR_BATCH_MAX) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "The mcursor::nextBatch() method takes one argument: the maximum number of records to return", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   if (async) {
+      ahead_request(args, isolate, cx, pmeth, max);
+      return;
+   }
+   if (ahead_busy(args, cx, pmeth, 0)) {
+      return;
+   }
+
+   DBX_DBFUN_START(c, pcon, pmeth);
+
+   if (cx->ahead[cx->ahead_cur].state != 2 && !cx->ahead_eod) {
+      /* nothing has been read ahead: fetch the batch on this thread */
+      cx->batch_size = max;
+      cx->fetch_buf = cx->ahead_cur;
+      cx->ahead[cx->fetch_buf].state = 1;
+      pmeth->pcursor = (void *) cx;
+      dbx_cursor_fetch(pmeth);
+      ahead_filled(cx, pmeth);
+   }
+
+   DBX_DBFUN_END(c);
+
+   if (cx->ahead[cx->ahead_cur].state != 2 && cx->ahead_error[0]) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, cx->ahead_error, 1)));
+      cx->ahead_error[0] = '\0';
+   }
+   else {
+      args.GetReturnValue().Set(ahead_take(isolate, cx, max));
+   }
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
+
+
 void mcursor::Previous(const FunctionCallbackInfo<Value>& args)
 {
    short async;
@@ -596,6 +723,9 @@ void mcursor::Previous(const FunctionCallbackInfo<Value>& args)
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
+   if (ahead_busy(args, cx, pmeth, 1)) { /* v2.1.20 */
+      return;
+   }
 
    if (cx->context == 1) {
    
@@ -792,6 +922,10 @@ void mcursor::Reset(const FunctionCallbackInfo<Value>& args)
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
+   if (ahead_busy(args, cx, pmeth, 0)) { /* v2.1.20 */
+      return;
+   }
+   ahead_reset(cx);
 
    /* 1.4.10 */
    rc = dbx_cursor_reset(args, isolate, pcon, pmeth, (void *) cx, 0, 0);
@@ -808,7 +942,6 @@ void mcursor::Reset(const FunctionCallbackInfo<Value>& args)
 
 void mcursor::Close(const FunctionCallbackInfo<Value>& args)
 {
-   int cn;
    DBXCON *pcon;
    DBXMETH *pmeth;
    mcursor *cx = ObjectWrap::Unwrap<mcursor>(args.This());
@@ -835,44 +968,392 @@ void mcursor::Close(const FunctionCallbackInfo<Value>& args)
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
    }
+   if (cx->pwait) { /* v2.1.20 */
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) DBX_TEXT_E_CURSOR_BUSY, 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+   if (cx->fetching) { /* v2.1.20 released once the read-ahead in progress completes */
+      cx->close_pending = 1;
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
 
-   if (cx->pqr_next) {
-      if (cx->pqr_next->data.svalue.buf_addr) {
-         dbx_free((void *) cx->pqr_next->data.svalue.buf_addr, 0);
-         cx->pqr_next->data.svalue.buf_addr = NULL;
-         cx->pqr_next->data.svalue.len_alloc = 0;
-         cx->pqr_next->data.svalue.len_used = 0;
+   cx->delete_mcursor_template(cx); /* v2.1.20 */
+
+   dbx_request_memory_free(pcon, pmeth, 0);
+   return;
+}
+
+
+/*
+   v2.1.20 Asynchronous traversal
+
+   Records are read ahead on a DB thread into two buffers: while JavaScript consumes
+   one, the next batch is fetched into the other.  Only one fetch is in progress for
+   a cursor at any time, so the pqr_prev/pqr_next state is only ever touched by one
+   thread, and one asynchronous next() or nextBatch() may wait on the cursor.
+*/
+
+int mcursor::ahead_request(const FunctionCallbackInfo<Value>& args, Isolate * isolate, mcursor *cx, DBXMETH *pmeth, int max)
+{
+   DBX_DBNAME *c = cx->c;
+   DBXCON *pcon = c->pcon;
+   DBX_DBNAME::dbx_baton_t *baton;
+
+   if (cx->pwait) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) DBX_TEXT_E_CURSOR_BUSY, 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return -1;
+   }
+   if (!pcon->use_mutex) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Asynchronous cursor operations are not available for connections opened with multithreaded set to false", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return -1;
+   }
+   if (!c->open) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) (pcon->error[0] ? pcon->error : "Database not open"), 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return -1;
+   }
+
+   baton = c->dbx_make_baton(c, pmeth);
+   baton->cx = (void *) cx;
+   baton->isolate = isolate;
+   baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_do_nothing;
+   DBX_BATON_CALLBACK(baton, pmeth->argc);
+
+   cx->Ref();
+   cx->pwait = (void *) baton;
+   cx->wait_max = max;
+   cx->batch_size = (max > DBX_CURSOR_READAHEAD) ? max : DBX_CURSOR_READAHEAD;
+
+   ahead_start(cx);
+
+   /* records (or the end of the dataset) are already to hand: complete on the next turn of the event loop */
+   if (cx->ahead[cx->ahead_cur].state == 2 || !cx->fetching) {
+      cx->wait_queued = 1;
+      if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) ahead_wait_complete, baton, DBX_TASK_NO_ADMISSION)) {
+         char error[DBX_ERROR_SIZE];
+
+         T_STRCPY(error, _dbxso(error), pcon->error);
+         cx->pwait = NULL;
+         cx->wait_queued = 0;
+         cx->Unref();
+         c->dbx_destroy_baton(baton, pmeth);
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
+         dbx_request_memory_free(pcon, pmeth, 0);
+         return -1;
       }
-      dbx_free((void *) cx->pqr_next, 0);
-      cx->pqr_next = NULL;
    }
+   return 0;
+}
 
-   if (cx->pqr_prev) {
-      if (cx->pqr_prev->data.svalue.buf_addr) {
-         dbx_free((void *) cx->pqr_prev->data.svalue.buf_addr, 0);
-         cx->pqr_prev->data.svalue.buf_addr = NULL;
-         cx->pqr_prev->data.svalue.len_alloc = 0;
-         cx->pqr_prev->data.svalue.len_used = 0;
+
+/* start reading the next batch into a free buffer */
+int mcursor::ahead_start(mcursor *cx)
+{
+   short n;
+   DBX_DBNAME *c = cx->c;
+   DBXMETH *pmeth;
+   DBX_DBNAME::dbx_baton_t *baton;
+
+   if (cx->fetching || cx->ahead_eod || cx->close_pending || !c || !c->open) {
+      return 0;
+   }
+   n = 1 - cx->ahead_cur;
+   if (cx->ahead[n].state != 0) {
+      n = cx->ahead_cur;
+      if (cx->ahead[n].state != 0) {
+         return 0;
       }
-      dbx_free((void *) cx->pqr_prev, 0);
-      cx->pqr_prev = NULL;
+   }
+   if (cx->batch_size < 1) {
+      cx->batch_size = DBX_CURSOR_READAHEAD;
    }
 
-   if (cx->psql) {
-      for (cn = 0; cn < cx->psql->no_cols; cn ++) {
-         if (cx->psql->cols[cn]) {
-            dbx_free((void *) cx->psql->cols[cn], 0);
-            cx->psql->cols[cn] = NULL;
+   pmeth = dbx_request_memory(c->pcon, 0);
+   if (!pmeth) {
+      return -1;
+   }
+   pmeth->pcursor = (void *) cx;
+   pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_cursor_fetch;
+
+   baton = c->dbx_make_baton(c, pmeth);
+   if (!baton) {
+      dbx_request_memory_free(c->pcon, pmeth, 0);
+      return -1;
+   }
+   baton->cx = (void *) cx;
+   baton->isolate = Isolate::GetCurrent();
+
+   cx->fetch_buf = n;
+   cx->ahead[n].state = 1;
+   cx->fetching = 1;
+   cx->Ref();
+
+   c->dbx_queue_task((void *) c->dbx_process_task, (void *) ahead_fetch_complete, baton, DBX_TASK_NO_ADMISSION);
+   return 1;
+}
+
+
+/* PRIMARY THREAD : take delivery of a batch filled by dbx_cursor_fetch() */
+int mcursor::ahead_filled(mcursor *cx, DBXMETH *pmeth)
+{
+   DBXCURBUF *pbuf = &(cx->ahead[cx->fetch_buf]);
+
+   cx->fetching = 0;
+   if (pmeth->error[0]) {
+      T_STRCPY(cx->ahead_error, _dbxso(cx->ahead_error), pmeth->error);
+   }
+   if (pbuf->eod) {
+      cx->ahead_eod = 1;
+   }
+   pbuf->state = (pbuf->nrec > 0) ? 2 : 0;
+   if (pbuf->state == 2 && cx->ahead[cx->ahead_cur].state != 2) {
+      cx->ahead_cur = cx->fetch_buf;
+   }
+   return 0;
+}
+
+
+/* complete the waiting request if its records have arrived */
+int mcursor::ahead_service(mcursor *cx)
+{
+   Isolate* isolate = Isolate::GetCurrent();
+   HandleScope scope(isolate);
+   DBX_DBNAME::dbx_baton_t *baton = (DBX_DBNAME::dbx_baton_t *) cx->pwait;
+   DBX_DBNAME *c;
+   Local<Value> argv[2];
+   char error[DBX_ERROR_SIZE];
+
+   if (!baton || cx->wait_queued) {
+      return 0;
+   }
+   if (cx->ahead[cx->ahead_cur].state != 2 && cx->fetching) {
+      return 0;
+   }
+
+   c = baton->c;
+   cx->pwait = NULL;
+   error[0] = '\0';
+   if (cx->ahead[cx->ahead_cur].state != 2 && cx->ahead_error[0]) {
+      T_STRCPY(error, _dbxso(error), cx->ahead_error);
+      cx->ahead_error[0] = '\0';
+      argv[0] = DBX_INTEGER_NEW(true);
+      argv[1] = dbx_new_string8(isolate, error, 1);
+   }
+   else {
+      argv[0] = DBX_INTEGER_NEW(false);
+      argv[1] = ahead_take(isolate, cx, cx->wait_max);
+   }
+
+   /* fetch the next batch while JavaScript processes this one */
+   ahead_start(cx);
+
+   cx->async_callback(cx);
+   c->dbx_complete_baton(baton, argv, error);
+
+   dbx_request_memory_free(baton->pmeth->pcon, baton->pmeth, 0);
+   c->dbx_destroy_baton(baton, baton->pmeth);
+   return 1;
+}
+
+
+/* return the next record (max == 0) or an array of up to max records */
+Local<Value> mcursor::ahead_take(Isolate * isolate, mcursor *cx, int max)
+{
+   int n;
+#if DBX_NODE_VERSION >= 100000
+   Local<Context> icontext = isolate->GetCurrentContext();
+#endif
+
+   if (max < 1) {
+      if (cx->ahead[cx->ahead_cur].state != 2) {
+         return DBX_NULL();
+      }
+      return ahead_record(isolate, cx, &(cx->ahead[cx->ahead_cur]));
+   }
+
+   Local<Array> a = DBX_ARRAY_NEW(0);
+   for (n = 0; n < max && cx->ahead[cx->ahead_cur].state == 2; n ++) {
+      DBX_SET(a, n, ahead_record(isolate, cx, &(cx->ahead[cx->ahead_cur])));
+   }
+   return a;
+}
+
+
+/* convert the next record in a buffer to the form returned by the synchronous next() method */
+Local<Value> mcursor::ahead_record(Isolate * isolate, mcursor *cx, DBXCURBUF *pbuf)
+{
+   int n, nfields, nkeys;
+   int flen[DBX_CURSOR_MAXFIELDS];
+   char *p, *fdata[DBX_CURSOR_MAXFIELDS];
+   char buffer[32], delim[4];
+   short utf8 = cx->c->pcon->utf8;
+   Local<Value> result;
+   Local<Object> obj;
+   Local<String> key;
+#if DBX_NODE_VERSION >= 100000
+   Local<Context> icontext = isolate->GetCurrentContext();
+#endif
+
+   p = (char *) pbuf->rec.buf_addr + pbuf->offs;
+   memcpy((void *) &nfields, (void *) p, sizeof(int));
+   p += sizeof(int);
+   for (n = 0; n < nfields; n ++) {
+      memcpy((void *) &flen[n], (void *) p, sizeof(int));
+      p += sizeof(int);
+      fdata[n] = p;
+      p += flen[n];
+   }
+
+   if (cx->context == 1) {
+      if (cx->getdata == 0) {
+         result = dbx_new_string8n(isolate, fdata[0], flen[0], utf8);
+      }
+      else if (cx->format == 1) {
+         cx->data.len_used = 0;
+         dbx_escape_output(&(cx->data), (char *) "key=", 4, 0);
+         dbx_escape_output(&(cx->data), fdata[0], flen[0], 1);
+         dbx_escape_output(&(cx->data), (char *) "&data=", 6, 0);
+         dbx_escape_output(&(cx->data), fdata[1], flen[1], 1);
+         result = dbx_new_string8n(isolate, (char *) cx->data.buf_addr, cx->data.len_used, 0);
+      }
+      else {
+         obj = DBX_OBJECT_NEW();
+         key = dbx_new_string8(isolate, (char *) "key", 0);
+         DBX_SET(obj, key, dbx_new_string8n(isolate, fdata[0], flen[0], utf8));
+         key = dbx_new_string8(isolate, (char *) "data", 0);
+         DBX_SET(obj, key, dbx_new_string8n(isolate, fdata[1], flen[1], 0));
+         result = obj;
+      }
+   }
+   else if (cx->context == 2) {
+      nkeys = cx->getdata ? (nfields - 1) : nfields;
+      if (cx->format == 1) {
+         cx->data.len_used = 0;
+         *delim = '\0';
+         for (n = 0; n < nkeys; n ++) {
+            sprintf(buffer, (char *) "%skey%d=", delim, n + 1);
+            dbx_escape_output(&(cx->data), buffer, (int) strlen(buffer), 0);
+            dbx_escape_output(&(cx->data), fdata[n], flen[n], 1);
+            strcpy(delim, (char *) "&");
+         }
+         if (cx->getdata) {
+            sprintf(buffer, (char *) "%sdata=", delim);
+            dbx_escape_output(&(cx->data), buffer, (int) strlen(buffer), 0);
+            dbx_escape_output(&(cx->data), fdata[nkeys], flen[nkeys], 1);
          }
+         result = dbx_new_string8n(isolate, (char *) cx->data.buf_addr, cx->data.len_used, 0);
       }
-      dbx_free((void *) cx->psql, 0);
-      cx->psql = NULL;
+      else {
+         obj = DBX_OBJECT_NEW();
+         key = dbx_new_string8(isolate, (char *) "key", 0);
+         Local<Array> a = DBX_ARRAY_NEW(nkeys);
+         DBX_SET(obj, key, a);
+         for (n = 0; n < nkeys; n ++) {
+            DBX_SET(a, n, dbx_new_string8n(isolate, fdata[n], flen[n], 0));
+         }
+         if (cx->getdata) {
+            key = dbx_new_string8(isolate, (char *) "data", 0);
+            DBX_SET(obj, key, dbx_new_string8n(isolate, fdata[nkeys], flen[nkeys], 0));
+         }
+         result = obj;
+      }
+   }
+   else if (cx->context == 9) {
+      result = dbx_new_string8n(isolate, fdata[0], flen[0], utf8);
+   }
+   else {
+      obj = DBX_OBJECT_NEW();
+      for (n = 0; n < nfields && cx->psql && n < cx->psql->no_cols; n ++) {
+         key = dbx_new_string8n(isolate, (char *) cx->psql->cols[n]->name.buf_addr, cx->psql->cols[n]->name.len_used, 0);
+         DBX_SET(obj, key, dbx_new_string8n(isolate, fdata[n], flen[n], 0));
+      }
+      result = obj;
    }
 
-/*
-   cx->delete_mcursor_template(cx);
-*/
-   dbx_request_memory_free(pcon, pmeth, 0);
+   pbuf->offs = (unsigned int) (p - (char *) pbuf->rec.buf_addr);
+   pbuf->next_rec ++;
+   if (pbuf->next_rec >= pbuf->nrec) {
+      pbuf->state = 0;
+      if (cx->ahead[1 - cx->ahead_cur].state == 2) {
+         cx->ahead_cur = 1 - cx->ahead_cur;
+      }
+   }
+   return result;
+}
+
+
+/* discard records read ahead: the cursor is about to be repositioned */
+int mcursor::ahead_reset(mcursor *cx)
+{
+   int n;
+
+   for (n = 0; n < 2; n ++) {
+      cx->ahead[n].state = 0;
+      cx->ahead[n].eod = 0;
+      cx->ahead[n].nrec = 0;
+      cx->ahead[n].next_rec = 0;
+      cx->ahead[n].offs = 0;
+      cx->ahead[n].rec.len_used = 0;
+   }
+   cx->ahead_cur = 0;
+   cx->ahead_eod = 0;
+   cx->ahead_error[0] = '\0';
+   return 0;
+}
+
+
+/* synchronous methods may not run while the cursor is in use by a DB thread */
+int mcursor::ahead_busy(const FunctionCallbackInfo<Value>& args, mcursor *cx, DBXMETH *pmeth, short records)
+{
+   Isolate* isolate = args.GetIsolate();
+
+   if (cx->fetching || cx->pwait) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) DBX_TEXT_E_CURSOR_BUSY, 1)));
+      dbx_request_memory_free(cx->c->pcon, pmeth, 0);
+      return 1;
+   }
+   if (records && (cx->ahead[0].state == 2 || cx->ahead[1].state == 2)) {
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Records have been read ahead on this cursor: use reset() before calling previous()", 1)));
+      dbx_request_memory_free(cx->c->pcon, pmeth, 0);
+      return 1;
+   }
+   return 0;
+}
+
+
+async_rtn mcursor::ahead_fetch_complete(uv_work_t *req)
+{
+   DBX_DBNAME::dbx_baton_t *baton = static_cast<DBX_DBNAME::dbx_baton_t *>(req->data);
+   mcursor *cx = (mcursor *) baton->cx;
+   DBX_DBNAME *c = baton->c;
+
+   ahead_filled(cx, baton->pmeth);
+   dbx_request_memory_free(baton->pmeth->pcon, baton->pmeth, 0);
+   c->dbx_destroy_baton(baton, baton->pmeth);
+
+   if (cx->close_pending) {
+      cx->close_pending = 0;
+      cx->delete_mcursor_template(cx);
+   }
+   else {
+      ahead_service(cx);
+      ahead_start(cx);
+   }
+   cx->async_callback(cx);
    return;
 }
 
+
+async_rtn mcursor::ahead_wait_complete(uv_work_t *req)
+{
+   DBX_DBNAME::dbx_baton_t *baton = static_cast<DBX_DBNAME::dbx_baton_t *>(req->data);
+   mcursor *cx = (mcursor *) baton->cx;
+
+   cx->wait_queued = 0;
+   ahead_service(cx);
+   return;
+}
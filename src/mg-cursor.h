@@ -34,6 +34,22 @@
       return; \
    } \
 
+/* v2.1.20 asynchronous traversal: records are read ahead on a DB thread, a batch at a time */
+#define DBX_CURSOR_READAHEAD     64
+#define DBX_CURSOR_BATCH_MAX     100000
+#define DBX_CURSOR_MAXFIELDS     (DBX_MAXARGS + DBX_SQL_MAXCOL)
+
+#define DBX_TEXT_E_CURSOR_BUSY   "An asynchronous request is in progress on this cursor"
+
+typedef struct tagDBXCURBUF {
+   short          state;            /* 0: free; 1: being filled on a DB thread; 2: holds records not yet returned */
+   short          eod;
+   int            nrec;
+   int            next_rec;
+   unsigned int   offs;
+   DBXSTR         rec;              /* records: field count followed by the length and value of each field */
+} DBXCURBUF, *PDBXCURBUF;
+
 class mcursor : public node::ObjectWrap
 {
 public:
@@ -50,6 +66,17 @@ public:
    DBXSTR         data;
    DBXSQL         *psql;
    DBX_DBNAME     *c;
+   short          fetching;         /* v2.1.20 read-ahead state */
+   short          fetch_buf;
+   short          ahead_eod;
+   short          ahead_cur;
+   short          close_pending;
+   short          wait_queued;
+   int            batch_size;
+   int            wait_max;
+   void           *pwait;
+   DBXCURBUF      ahead[2];
+   char           ahead_error[DBX_ERROR_SIZE];
 
 
 #if DBX_NODE_VERSION >= 100000
@@ -67,10 +94,22 @@ public:
    static void       Execute                 (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Cleanup                 (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Next                    (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void       NextBatch               (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Previous                (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Reset                   (const v8::FunctionCallbackInfo<v8::Value>& args);
    static void       Close                   (const v8::FunctionCallbackInfo<v8::Value>& args);
 
+   static int        ahead_request           (const v8::FunctionCallbackInfo<v8::Value>& args, v8::Isolate * isolate, mcursor *cx, DBXMETH *pmeth, int max);
+   static int        ahead_start             (mcursor *cx);
+   static int        ahead_filled            (mcursor *cx, DBXMETH *pmeth);
+   static int        ahead_service           (mcursor *cx);
+   static v8::Local<v8::Value> ahead_take    (v8::Isolate * isolate, mcursor *cx, int max);
+   static v8::Local<v8::Value> ahead_record  (v8::Isolate * isolate, mcursor *cx, DBXCURBUF *pbuf);
+   static int        ahead_reset             (mcursor *cx);
+   static int        ahead_busy              (const v8::FunctionCallbackInfo<v8::Value>& args, mcursor *cx, DBXMETH *pmeth, short records);
+   static async_rtn  ahead_fetch_complete    (uv_work_t *req);
+   static async_rtn  ahead_wait_complete     (uv_work_t *req);
+
 private:
 
    static void       New                     (const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -117,6 +117,52 @@ Version 2.1.19 15 August 2020:
    - For information, the Cache library was renamed from libcache to libisccache and the IRIS library from libirisdb to libisciris.db
    - This change does not affect Windows platforms.
 
+Version 2.1.20 17 October 2026:
+   Recycle request memory blocks through a per-connection free-list instead of allocating and releasing them for each call.
+   - Idle blocks are capped and buffers that have grown past a high-water mark are shrunk before re-use.
+   - Pool usage statistics can be obtained through the new memstats() method.
+   Serve native memory allocations from size-class free-lists and account for them by subsystem.
+   - The memstats() method reports the allocator's statistics together with the bytes and blocks currently held by each subsystem.
+   Correct a memory leak in the logmessage() method.
+   Reduce the size of the request block.
+   - Frequently used fields are grouped at the start of the block and argument descriptors for the first eight arguments are held inline, with larger argument lists moving to a heap extension.
+   - Request blocks are no longer reset argument by argument on every call.
+   Network connections: accept response values larger than 32000 bytes.
+   - The output buffer is sized from the length of the response and grows in power-of-two steps.
+   - The _bx methods hand a large response buffer to Node.js without copying it.
+   Correct a fault in the _bx methods that could lead to the output buffer being released twice.
+   Cursors: hold the current subscripts in a compact key arena that is allocated on first use and grows on demand.
+   - Cursors over long string subscripts are supported and an idle cursor holds only a few kilobytes of memory.
+   - Memory held by a cursor is released when the cursor is closed or garbage collected.
+   Network connections: correct the mcursor next() and previous() methods when data is not requested.
+   mglobal: encode the global name and fixed subscripts once, when the object is created or reset, rather than on every call.
+   - Memory held by an mglobal object is released when the object is closed or garbage collected.
+   Encode integer subscripts directly into the request buffer without going through sprintf() or a JavaScript string conversion.
+   - Integer subscripts are pushed as native integers through the InterSystems API.
+   Asynchronous requests are passed directly to the mg-dbx thread pool, which signals the event loop on completion (uv_async_send) rather than holding a libuv worker thread for the duration of each request (POSIX).
+   Requests waiting on the thread pool are woken through a completion signal private to the request instead of a broadcast on a global condition variable polled every 3 seconds.
+   Asynchronous requests are processed by a thread pool that is created once per database API, or per network connection, and shut down when the (last) connection is closed.
+   - Introduce the pool_size property for the open() method: each thread of a network connection's pool has its own connection to the server.
+   Network connections are serialized on a mutex of their own rather than on the mutex shared with the in-process database APIs, so that independent connections can process requests in parallel.
+   Replace the thread pool's mutex-protected task list with a bounded lock-free queue whose nodes are embedded in the request block.
+   - Queue depth and the time requests wait before a thread starts on them are reported by the new poolstats() method.
+   Introduce Promise returning variants of the asynchronous methods (e.g. getAsync()).
+   - Request blocks (batons) are recycled through a per-connection free list.
+   Cursors: introduce asynchronous traversal with next(callback) and the new nextBatch() method.
+   - Records are read ahead on a DB thread into a pair of buffers, one batch at a time.
+   Introduce admission control for asynchronous requests: the max_inflight, max_queue and overflow properties for open() and the saturation() method.
+   Introduce the coalesce property for open(): identical asynchronous reads in progress share one request to the database.
+   Deliver asynchronous completions in batches of up to 256 per turn of the event loop under a single handle scope and callback scope.
+   Schedule asynchronous requests in two lanes (short and long) so that long running requests are confined to a subset of the pool's threads: the long_threads property for open() and the lane() method.
+   Introduce a process-wide connection broker for network based connections, shared by all threads (the shared property for open()).
+   Introduce the pool_min property for open(): threads of a network connection's pool, and their connections to the server, are started on demand up to pool_size (which may also be given as pool).
+   - Idle connections are checked, and lost connections replaced, before a request is sent.
+   Introduce the pipeline property for open(): requests tagged with an ID (revision 2 of the network protocol) are pipelined over one connection to the server and matched to their responses by a reader thread.
+   Read responses from the server through a per-connection receive buffer: a response is normally taken in one read, and a response split across TCP segments is no longer returned short.
+   Wait on network sockets with poll() rather than select() (UNIX), so that connections work with descriptors above FD_SETSIZE.
+   Send Buffer arguments of 64KB or more for network connections straight from the Buffer with sendmsg() rather than copying them into the request (MSG_ZEROCOPY on Linux for 256KB or more).
+   Introduce the 'transport' property for the open() method: with transport: "uv" asynchronous network requests are written and their responses read by the event loop, without threads.
+
 */
 
 
@@ -136,33 +182,32 @@ extern int errno;
 
 static int     dbx_counter             = 0;
 static int     dbx_sql_counter         = 0;
-int            dbx_total_tasks         = 0;
 int            dbx_request_errors      = 0;
 
 #if defined(_WIN32)
 CRITICAL_SECTION  dbx_async_mutex;
 #else
 pthread_mutex_t   dbx_async_mutex        = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t   dbx_pool_mutex         = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t   dbx_result_mutex       = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t   dbx_task_queue_mutex   = PTHREAD_MUTEX_INITIALIZER;
-
-pthread_cond_t    dbx_pool_cond           = PTHREAD_COND_INITIALIZER;
-pthread_cond_t    dbx_result_cond         = PTHREAD_COND_INITIALIZER;
-
-DBXTID            dbx_thr_id[DBX_THREADPOOL_MAX];
-pthread_t         dbx_p_threads[DBX_THREADPOOL_MAX];
+pthread_once_t    dbx_mem_once           = PTHREAD_ONCE_INIT;
+pthread_key_t     dbx_mem_key;
 #endif
 
-struct dbx_pool_task * tasks           = NULL;
-struct dbx_pool_task * bottom_task     = NULL;
-
 DBXCON * pcon_api = NULL;
 
 DBXISCSO *  p_isc_so_global = NULL;
 DBXYDBSO *  p_ydb_so_global = NULL;
 DBXMUTEX    mutex_global;
 
+DBXMEMSTATS dbx_mem_stats_global; /* v2.1.20 */
+DBX_THREAD_LOCAL DBXMEMCACHE dbx_mem_cache_thread; /* v2.1.20 */
+
+DBX_THREAD_LOCAL short dbx_promise_call = 0; /* v2.1.20 */
+
+DBXBROKER * dbx_broker_head = NULL; /* v2.1.20 */
+
+static const int dbx_mem_class_size[DBX_MEM_CLASSES] = {32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, DBX_MEM_CLASS_IBUFFER, DBX_MEM_CLASS_MAX};
+static const char * dbx_mem_tag_names[DBX_MEM_TAGS] = {"general", "unused", "request", "ibuffer", "global", "cursor", "task", "sql", "error", "connection"};
+
 using namespace node;
 using namespace v8;
 
@@ -202,6 +247,7 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpReserved)
       case DLL_THREAD_ATTACH:
          break;
       case DLL_THREAD_DETACH:
+         dbx_mem_thread_exit(NULL);
          break;
       case DLL_PROCESS_DETACH:
          DeleteCriticalSection(&dbx_async_mutex);
@@ -265,6 +311,29 @@ void DBX_DBNAME::Init(Handle<Object> exports)
 
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "sleep", Sleep);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "benchmark", Benchmark);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "memstats", MemStats);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "poolstats", PoolStats);
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "saturation", Saturation); /* v2.1.20 */
+   DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "lane", Lane); /* v2.1.20 */
+
+   /* v2.1.20 Promise-returning variants of the asynchronous methods */
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "open", Open);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "close", Close);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "namespace", Namespace);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "get", Get);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "get_bx", Get_bx);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "set", Set);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "defined", Defined);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "delete", Delete);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "next", Next);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "previous", Previous);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "increment", Increment);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "lock", Lock);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "unlock", Unlock);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "function", ExtFunction);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "function_bx", ExtFunction_bx);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "classmethod", ClassMethod);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "classmethod_bx", ClassMethod_bx);
 
 #if DBX_NODE_VERSION >= 120000
    constructor.Reset(isolate, tpl->GetFunction(icontext).ToLocalChecked());
@@ -283,6 +352,13 @@ DBX_DBNAME::DBX_DBNAME(int value) : dbx_count(value)
 
 DBX_DBNAME::~DBX_DBNAME()
 {
+   dbx_baton_t *baton;
+
+   while ((baton = baton_pool)) { /* v2.1.20 */
+      baton_pool = baton->pnext;
+      delete baton;
+   }
+   saturation_cb.Reset();
 }
 
 
@@ -311,6 +387,15 @@ void DBX_DBNAME::New(const FunctionCallbackInfo<Value>& args)
    c->csize = 8;
 
    c->pcon = NULL;
+   c->baton_pool = NULL; /* v2.1.20 */
+   c->baton_pool_idle = 0;
+   c->admit_head = NULL;
+   c->admit_tail = NULL;
+   c->admit_held = 0;
+   c->saturated = 0;
+   c->saturated_reported = 0;
+   memset((void *) c->coalesce_table, 0, sizeof(c->coalesce_table)); /* v2.1.20 */
+   c->lane_next = DBX_LANE_DEFAULT;
 
    c->use_mutex = 1; /* v2.1.17 */
    c->p_mutex = &mutex_global;
@@ -320,13 +405,33 @@ void DBX_DBNAME::New(const FunctionCallbackInfo<Value>& args)
    c->isolate = NULL;
    c->got_icontext = 0;
 
-   c->pcon = (DBXCON *) dbx_malloc(sizeof(DBXCON), 0);
+   c->pcon = (DBXCON *) dbx_malloc(sizeof(DBXCON), 901);
    memset((void *) c->pcon, 0, sizeof(DBXCON));
 
    c->pcon->p_mutex = &mutex_global;
    c->pcon->p_zv = NULL;
 
    c->pcon->pmeth_base = (void *) dbx_request_memory_alloc(c->pcon, 0);
+   c->pcon->pmeth_pool = NULL; /* v2.1.20 */
+   c->pcon->pmeth_pool_idle = 0;
+   c->pcon->pmeth_pool_max = DBX_METH_POOL_MAX;
+   c->pcon->pmeth_pool_hits = 0;
+   c->pcon->pmeth_pool_misses = 0;
+   c->pcon->pasync = NULL;
+   c->pcon->max_inflight = 0; /* v2.1.20 no limit */
+   c->pcon->max_queue = DBX_ADMIT_QUEUE_MAX;
+   c->pcon->overflow = DBX_OVERFLOW_REJECT;
+   c->pcon->coalesce = 0; /* v2.1.20 */
+   c->pcon->long_threads = 0;
+   c->pcon->pool_min = 0; /* v2.1.20 all threads are started by open() */
+   c->pcon->shared = 0;
+   c->pcon->pbroker = NULL;
+   c->pcon->pipeline = 0; /* v2.1.20 */
+   c->pcon->net_revision = 1;
+   c->pcon->ppipe = NULL;
+   c->pcon->transport = DBX_TRANSPORT_THREADS; /* v2.1.20 */
+   c->pcon->puv = NULL;
+   c->pcon->coalesced = 0;
 
    c->pcon->utf8 = 1; /* seems to be faster with UTF8 on! */
    c->pcon->net_connection = 0;
@@ -355,42 +460,435 @@ DBX_DBNAME::dbx_baton_t * DBX_DBNAME::dbx_make_baton(DBX_DBNAME *c, DBXMETH *pme
 {
    dbx_baton_t *baton;
 
-   baton = new dbx_baton_t();
+   /* v2.1.20 batons are recycled through a per-object free-list */
+   if ((baton = c->baton_pool)) {
+      c->baton_pool = baton->pnext;
+      c->baton_pool_idle --;
+   }
+   else {
+      baton = new dbx_baton_t();
+   }
 
    if (!baton) {
       return NULL;
    }
+   baton->pnext = NULL;
+   baton->promise = 0;
    baton->c = c;
    baton->gx = NULL;
    baton->cx = NULL;
    baton->clx = NULL;
    baton->pmeth = pmeth;
+   baton->coalesce = 0; /* v2.1.20 */
+   baton->pchain = NULL;
+   baton->pfollow_head = NULL;
+   baton->pfollow_tail = NULL;
    return baton;
 }
 
 
 int DBX_DBNAME::dbx_destroy_baton(dbx_baton_t *baton, DBXMETH *pmeth)
 {
+   DBX_DBNAME *c;
+
    if (baton) {
-      delete baton;
+      c = baton->c;
+      baton->cb.Reset();
+      baton->resolver.Reset();
+      if (c && c->baton_pool_idle < DBX_BATON_POOL_MAX) { /* v2.1.20 */
+         baton->pnext = c->baton_pool;
+         c->baton_pool = baton;
+         c->baton_pool_idle ++;
+      }
+      else {
+         delete baton;
+      }
+   }
+
+   return 0;
+}
+
+
+/* v2.1.20 PRIMARY THREAD : deliver the result to the callback or settle the Promise */
+void DBX_DBNAME::dbx_complete_baton(dbx_baton_t *baton, Local<Value> argv[2], char *error)
+{
+   Isolate* isolate = Isolate::GetCurrent();
+
+   if (!error) {
+      error = baton->pmeth->error; /* v2.1.20 */
+   }
+
+#if DBX_NODE_VERSION >= 100000
+   node::async_context actx = {0, 0};
+   node::CallbackScope cscope(isolate, baton->c->handle(), actx); /* runs the microtask queue once the outermost scope closes */
+
+   if (baton->promise) {
+      Local<Context> context = isolate->GetCurrentContext();
+      Local<Promise::Resolver> resolver = Local<Promise::Resolver>::New(isolate, baton->resolver);
+
+      if (error[0]) {
+         resolver->Reject(context, Exception::Error(dbx_new_string8(isolate, error, 1))).FromJust();
+      }
+      else {
+         resolver->Resolve(context, argv[1]).FromJust();
+      }
+      baton->resolver.Reset();
+      return;
+   }
+#endif
+
+#if DBX_NODE_VERSION < 80000
+   TryCatch try_catch;
+#endif
+
+   Local<Function> cb = Local<Function>::New(isolate, baton->cb);
+
+#if DBX_NODE_VERSION >= 120000
+   /* cb->Call(isolate->GetCurrentContext(), isolate->GetCurrentContext()->Global(), 2, argv); */
+   cb->Call(isolate->GetCurrentContext(), Null(isolate), 2, argv).ToLocalChecked();
+#else
+   cb->Call(isolate->GetCurrentContext()->Global(), 2, argv);
+#endif
+
+#if DBX_NODE_VERSION < 80000
+   if (try_catch.HasCaught()) {
+      node::FatalException(isolate, try_catch);
+   }
+#endif
+
+   baton->cb.Reset();
+   return;
+}
+
+
+/* v2.1.20 PRIMARY THREAD : admission control; returns 0 to submit the request, 1 if it is held back or -1 if it is refused */
+int DBX_DBNAME::dbx_admit(dbx_baton_t *baton, void *after_work_cb)
+{
+#if !defined(_WIN32)
+   DBX_DBNAME *c = baton->c;
+   DBXCON *pcon = baton->pmeth->pcon;
+   DBXASYNC *pasync = (DBXASYNC *) pcon->pasync;
+
+   if (!c->admit_head && __atomic_load_n(&(pcon->inflight), __ATOMIC_SEQ_CST) < pcon->max_inflight) {
+      return 0;
+   }
+
+   c->saturated = 1;
+
+   if (pcon->overflow == DBX_OVERFLOW_QUEUE && c->admit_held < pcon->max_queue) {
+      baton->after_work_cb = after_work_cb;
+      baton->pnext = NULL;
+      if (c->admit_tail) {
+         c->admit_tail->pnext = baton;
+      }
+      else {
+         c->admit_head = baton;
+      }
+      c->admit_tail = baton;
+      c->admit_held ++;
+      pcon->admit_queued ++;
+      return 1;
+   }
+
+   if (pcon->overflow == DBX_OVERFLOW_BLOCK) {
+      if (pcon->puv) { /* v2.1.20 no thread will complete the requests in progress: deal with their responses here */
+         while (__atomic_load_n(&(pcon->inflight), __ATOMIC_SEQ_CST) >= pcon->max_inflight && netx_uv_service((NETXUV *) pcon->puv, -1) > 0) {
+            ;
+         }
+      }
+      pthread_mutex_lock(&(pasync->mutex));
+      __atomic_store_n(&(pcon->admit_waiting), 1, __ATOMIC_SEQ_CST);
+      while (__atomic_load_n(&(pcon->inflight), __ATOMIC_SEQ_CST) >= pcon->max_inflight) {
+         pthread_cond_wait(&(pasync->admit_cond), &(pasync->mutex));
+      }
+      __atomic_store_n(&(pcon->admit_waiting), 0, __ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&(pasync->mutex));
+      pcon->admit_blocked ++;
+      return 0;
+   }
+
+   /* refused: release the reference taken on the caller's object */
+   if (baton->gx)
+      ((mglobal *) baton->gx)->async_callback((mglobal *) baton->gx);
+   else if (baton->cx)
+      ((mcursor *) baton->cx)->async_callback((mcursor *) baton->cx);
+   else if (baton->clx)
+      ((mclass *) baton->clx)->async_callback((mclass *) baton->clx);
+   else
+      c->Unref();
+
+   pcon->admit_rejected ++;
+   T_STRCPY(pcon->error, _dbxso(pcon->error), DBX_TEXT_E_OVERLOAD);
+   pcon->error_code = DBX_ERROR_OVERLOAD;
+   return -1;
+#else
+   return 0;
+#endif
+}
+
+
+/* v2.1.20 PRIMARY THREAD : submit held requests as capacity allows and report changes in saturation */
+int DBX_DBNAME::dbx_admit_drain(DBX_DBNAME *c)
+{
+#if !defined(_WIN32)
+   int inflight;
+   DBXCON *pcon = c->pcon;
+   DBXASYNC *pasync = (DBXASYNC *) pcon->pasync;
+   dbx_baton_t *baton;
+
+   if (!pasync) {
+      return 0;
+   }
+
+   while (c->admit_head && __atomic_load_n(&(pcon->inflight), __ATOMIC_SEQ_CST) < pcon->max_inflight) {
+      baton = c->admit_head;
+      c->admit_head = baton->pnext;
+      if (!c->admit_head) {
+         c->admit_tail = NULL;
+      }
+      c->admit_held --;
+      baton->pnext = NULL;
+      if (dbx_async_submit(pasync, baton->pmeth, (void *) &(baton->work), baton->after_work_cb) != CACHE_SUCCESS) {
+         uv_queue_work(pasync->async.loop, &(baton->work), (uv_work_cb) dbx_process_task, (uv_after_work_cb) baton->after_work_cb);
+      }
+   }
+
+   if (c->saturated_reported == c->saturated && c->saturated == 0) {
+      return 0;
+   }
+
+   Isolate* isolate = Isolate::GetCurrent();
+   HandleScope scope(isolate);
+   Local<Value> argv[1];
+
+   inflight = __atomic_load_n(&(pcon->inflight), __ATOMIC_SEQ_CST);
+   if (c->saturated && !c->saturated_reported) {
+      c->saturated_reported = 1;
+      if (!c->saturation_cb.IsEmpty()) {
+         argv[0] = DBX_BOOLEAN_NEW(true);
+         dbx_saturation_callback(c, argv);
+      }
+   }
+   /* saturation ends once the held requests have been submitted and half of the capacity is free */
+   if (c->saturated && !c->admit_head && inflight <= (pcon->max_inflight / 2)) {
+      c->saturated = 0;
+   }
+   if (!c->saturated && c->saturated_reported) {
+      c->saturated_reported = 0;
+      if (!c->saturation_cb.IsEmpty()) {
+         argv[0] = DBX_BOOLEAN_NEW(false);
+         dbx_saturation_callback(c, argv);
+      }
+   }
+#endif
+   return 0;
+}
+
+
+/* v2.1.20 PRIMARY THREAD : the connection is closing: submit any held requests regardless of the limit */
+int DBX_DBNAME::dbx_admit_flush(DBX_DBNAME *c)
+{
+#if !defined(_WIN32)
+   int max_inflight;
+   DBXCON *pcon = c->pcon;
+
+   if (c->admit_head) {
+      max_inflight = pcon->max_inflight;
+      pcon->max_inflight = 0x7fffffff;
+      dbx_admit_drain(c);
+      pcon->max_inflight = max_inflight;
+   }
+#endif
+   return 0;
+}
+
+
+void DBX_DBNAME::dbx_saturation_callback(DBX_DBNAME *c, Local<Value> argv[1])
+{
+   Isolate* isolate = Isolate::GetCurrent();
+   Local<Function> cb = Local<Function>::New(isolate, c->saturation_cb);
+
+#if DBX_NODE_VERSION >= 100000
+   node::async_context actx = {0, 0};
+   node::CallbackScope cscope(isolate, c->handle(), actx);
+#endif
+
+#if DBX_NODE_VERSION >= 120000
+   cb->Call(isolate->GetCurrentContext(), Null(isolate), 1, argv).ToLocalChecked();
+#else
+   cb->Call(isolate->GetCurrentContext()->Global(), 1, argv);
+#endif
+   return;
+}
+
+
+/* v2.1.20 PRIMARY THREAD : returns 1 if the read request has been attached to an identical request in progress, otherwise 0 (the request may then be attached to) */
+int DBX_DBNAME::dbx_coalesce(dbx_baton_t *baton)
+{
+   unsigned int n, hash;
+   DBX_DBNAME *c = baton->c;
+   DBXMETH *pmeth = baton->pmeth;
+   dbx_baton_t *pleader;
+
+   if (pmeth->binary || pmeth->iov_n || pmeth->ibuffer_used > DBX_COALESCE_KEY_MAX) {
+      return 0;
+   }
+   if (pmeth->p_dbxfun != (int (*) (struct tagDBXMETH * pmeth)) dbx_get && pmeth->p_dbxfun != (int (*) (struct tagDBXMETH * pmeth)) dbx_defined &&
+       pmeth->p_dbxfun != (int (*) (struct tagDBXMETH * pmeth)) dbx_next && pmeth->p_dbxfun != (int (*) (struct tagDBXMETH * pmeth)) dbx_previous) {
+      return 0;
+   }
+
+   /* FNV-1a over the function and the encoded global reference */
+   hash = 2166136261U ^ (unsigned int) ((unsigned long) pmeth->p_dbxfun >> 4);
+   for (n = 0; n < pmeth->ibuffer_used; n ++) {
+      hash = (hash ^ pmeth->ibuffer[n]) * 16777619U;
+   }
+
+   for (pleader = c->coalesce_table[hash % DBX_COALESCE_HASH]; pleader; pleader = pleader->pchain) {
+      if (pleader->coalesce_hash == hash && pleader->coalesce_fun == (void *) pmeth->p_dbxfun && pleader->coalesce_len == pmeth->ibuffer_used && !memcmp((void *) pleader->coalesce_key, (void *) pmeth->ibuffer, (size_t) pmeth->ibuffer_used)) {
+         break;
+      }
+   }
+
+   if (pleader) {
+      if (pleader->pfollow_tail) {
+         pleader->pfollow_tail->pnext = baton;
+      }
+      else {
+         pleader->pfollow_head = baton;
+      }
+      pleader->pfollow_tail = baton;
+      baton->pnext = NULL;
+      /* the follower only needs its callback: its request block can be re-used straight away */
+      baton->pmeth = NULL;
+      dbx_request_memory_free(pmeth->pcon, pmeth, 0);
+      pleader->pmeth->pcon->coalesced ++;
+      return 1;
    }
 
+   baton->coalesce = 1;
+   baton->coalesce_hash = hash;
+   baton->coalesce_fun = (void *) pmeth->p_dbxfun;
+   baton->coalesce_len = pmeth->ibuffer_used;
+   memcpy((void *) baton->coalesce_key, (void *) pmeth->ibuffer, (size_t) pmeth->ibuffer_used);
+   baton->pchain = c->coalesce_table[hash % DBX_COALESCE_HASH];
+   c->coalesce_table[hash % DBX_COALESCE_HASH] = baton;
+
    return 0;
 }
 
 
+/* v2.1.20 PRIMARY THREAD : stop a request from accepting followers */
+void DBX_DBNAME::dbx_coalesce_unlink(dbx_baton_t *baton)
+{
+   dbx_baton_t **ppbaton;
+
+   if (baton->coalesce != 1) {
+      return;
+   }
+   for (ppbaton = &(baton->c->coalesce_table[baton->coalesce_hash % DBX_COALESCE_HASH]); *ppbaton; ppbaton = &((*ppbaton)->pchain)) {
+      if (*ppbaton == baton) {
+         *ppbaton = baton->pchain;
+         break;
+      }
+   }
+   baton->pchain = NULL;
+   baton->coalesce = 2;
+   return;
+}
+
+
+/* v2.1.20 PRIMARY THREAD : requests made from now on must not attach to those already in progress (e.g. after a change of namespace) */
+void DBX_DBNAME::dbx_coalesce_reset(DBX_DBNAME *c)
+{
+   int n;
+
+   for (n = 0; n < DBX_COALESCE_HASH; n ++) {
+      while (c->coalesce_table[n]) {
+         dbx_coalesce_unlink(c->coalesce_table[n]);
+      }
+   }
+   return;
+}
+
+
+/* v2.1.20 PRIMARY THREAD : deliver the result of a request to its own callback and those of the requests attached to it */
+void DBX_DBNAME::dbx_coalesce_complete(dbx_baton_t *baton, Local<Value> argv[2])
+{
+   char error[DBX_ERROR_SIZE];
+   dbx_baton_t *pfollow, *pnext;
+
+   dbx_coalesce_unlink(baton);
+   baton->coalesce = 0;
+
+   /* the outcome is the leader's own: take a copy before any callback runs */
+   T_STRCPY(error, _dbxso(error), baton->pmeth->error);
+   pfollow = baton->pfollow_head;
+   baton->pfollow_head = NULL;
+   baton->pfollow_tail = NULL;
+
+   dbx_complete_baton(baton, argv, error);
+
+   while (pfollow) {
+      pnext = pfollow->pnext;
+      if (pfollow->gx)
+         ((mglobal *) pfollow->gx)->async_callback((mglobal *) pfollow->gx);
+      else
+         pfollow->c->Unref();
+      dbx_complete_baton(pfollow, argv, error);
+      dbx_destroy_baton(pfollow, NULL);
+      pfollow = pnext;
+   }
+   return;
+}
+
+
 int DBX_DBNAME::dbx_queue_task(void * work_cb, void * after_work_cb, DBX_DBNAME::dbx_baton_t *baton, short context)
 {
-   uv_work_t *_req = new uv_work_t;
+   uv_loop_t *loop;
+   uv_work_t *_req = &(baton->work); /* v2.1.20 */
    _req->data = baton;
 
    /* v2.1.17 */
 #if DBX_NODE_VERSION >= 120000
-   uv_queue_work(GetCurrentEventLoop(baton->isolate), _req, (uv_work_cb) work_cb, (uv_after_work_cb) after_work_cb);
+   loop = GetCurrentEventLoop(baton->isolate);
 #else
-   uv_queue_work(uv_default_loop(), _req, (uv_work_cb) work_cb, (uv_after_work_cb) after_work_cb);
+   loop = uv_default_loop();
+#endif
+
+   /* v2.1.20 attach to an identical read request already in progress */
+   if (baton->pmeth->pcon->coalesce && after_work_cb == (void *) dbx_invoke_callback && dbx_coalesce(baton)) {
+      return 0;
+   }
+
+#if !defined(_WIN32)
+   /* v2.1.20 submit directly to the thread pool which signals the event loop on completion */
+   if (work_cb == (void *) dbx_process_task) {
+      DBXCON *pcon = baton->pmeth->pcon;
+      DBXASYNC *pasync = (DBXASYNC *) pcon->pasync;
+
+      if (!pasync) {
+         pasync = dbx_async_open(pcon, loop);
+      }
+      if (pasync && pcon->max_inflight > 0 && !(context & DBX_TASK_NO_ADMISSION)) {
+         int rc = dbx_admit(baton, after_work_cb);
+
+         if (rc < 0) {
+            dbx_coalesce_unlink(baton);
+            return -1;
+         }
+         if (rc > 0) { /* held back until a request in flight completes */
+            return 0;
+         }
+      }
+      if (pasync && dbx_async_submit(pasync, baton->pmeth, (void *) _req, after_work_cb) == CACHE_SUCCESS) {
+         return 0;
+      }
+   }
 #endif
 
+   uv_queue_work(loop, _req, (uv_work_cb) work_cb, (uv_after_work_cb) after_work_cb);
+
    return 0;
 }
 
@@ -437,13 +935,13 @@ async_rtn DBX_DBNAME::dbx_invoke_callback(uv_work_t *req)
 
    Local<Value> argv[2];
 
-   if (baton->pmeth->pcon->error[0])
+   if (baton->pmeth->error[0]) /* v2.1.20 */
       argv[0] = DBX_INTEGER_NEW(true);
    else
       argv[0] = DBX_INTEGER_NEW(false);
 
    if (baton->pmeth->binary) {
-      baton->result_obj = node::Buffer::New(isolate, (char *) baton->pmeth->output_val.svalue.buf_addr, (size_t) baton->pmeth->output_val.svalue.len_used).ToLocalChecked();
+      baton->result_obj = dbx_new_buffer(isolate, baton->pmeth);
       argv[1] = baton->result_obj;
    }
    else {
@@ -451,33 +949,18 @@ async_rtn DBX_DBNAME::dbx_invoke_callback(uv_work_t *req)
       argv[1] = baton->result_str;
    }
 
-#if DBX_NODE_VERSION < 80000
-   TryCatch try_catch;
-#endif
-
-   Local<Function> cb = Local<Function>::New(isolate, baton->cb);
-
-#if DBX_NODE_VERSION >= 120000
-   /* cb->Call(isolate->GetCurrentContext(), isolate->GetCurrentContext()->Global(), 2, argv); */
-   cb->Call(isolate->GetCurrentContext(), Null(isolate), 2, argv).ToLocalChecked();
-#else
-   cb->Call(isolate->GetCurrentContext()->Global(), 2, argv);
-#endif
-
-#if DBX_NODE_VERSION < 80000
-   if (try_catch.HasCaught()) {
-      node::FatalException(isolate, try_catch);
+   if (baton->coalesce) { /* v2.1.20 */
+      dbx_coalesce_complete(baton, argv);
+   }
+   else {
+      dbx_complete_baton(baton, argv); /* v2.1.20 */
    }
-#endif
-
-   baton->cb.Reset();
 
 	DBX_DBFUN_END(baton->c);
 
-   dbx_destroy_baton(baton, baton->pmeth);
    dbx_request_memory_free(baton->pmeth->pcon, baton->pmeth, 0);
+   dbx_destroy_baton(baton, baton->pmeth);
 
-   delete req;
    return;
 }
 
@@ -506,7 +989,7 @@ async_rtn DBX_DBNAME::dbx_invoke_callback_sql_execute(uv_work_t *req)
 
    Local<Value> argv[2];
 
-   if (baton->pmeth->pcon->error[0])
+   if (baton->pmeth->error[0]) /* v2.1.20 */
       argv[0] = DBX_INTEGER_NEW(true);
    else
       argv[0] = DBX_INTEGER_NEW(false);
@@ -517,9 +1000,9 @@ async_rtn DBX_DBNAME::dbx_invoke_callback_sql_execute(uv_work_t *req)
    DBX_SET(baton->result_obj, key, DBX_INTEGER_NEW(baton->pmeth->psql->sqlcode));
    key = dbx_new_string8(isolate, (char *) "sqlstate", 0);
    DBX_SET(baton->result_obj, key, dbx_new_string8(isolate, baton->pmeth->psql->sqlstate, 0));
-   if (baton->pmeth->pcon->error[0]) {
+   if (baton->pmeth->error[0]) {
       key = dbx_new_string8(isolate, (char *) "error", 0);
-      DBX_SET(baton->result_obj, key, dbx_new_string8(isolate, baton->pmeth->pcon->error, 0));
+      DBX_SET(baton->result_obj, key, dbx_new_string8(isolate, baton->pmeth->error, 0));
    }
    else if (baton->pmeth->psql->no_cols > 0) { /* v2.1.18 */
 
@@ -541,33 +1024,13 @@ async_rtn DBX_DBNAME::dbx_invoke_callback_sql_execute(uv_work_t *req)
 
    argv[1] =  baton->result_obj;
 
-#if DBX_NODE_VERSION < 80000
-   TryCatch try_catch;
-#endif
-
-   Local<Function> cb = Local<Function>::New(isolate, baton->cb);
-
-#if DBX_NODE_VERSION >= 120000
-   /* cb->Call(isolate->GetCurrentContext(), isolate->GetCurrentContext()->Global(), 2, argv); */
-   cb->Call(isolate->GetCurrentContext(), Null(isolate), 2, argv).ToLocalChecked();
-#else
-   cb->Call(isolate->GetCurrentContext()->Global(), 2, argv);
-#endif
-
-#if DBX_NODE_VERSION < 80000
-   if (try_catch.HasCaught()) {
-      node::FatalException(isolate, try_catch);
-   }
-#endif
-
-   baton->cb.Reset();
+   dbx_complete_baton(baton, argv); /* v2.1.20 */
 
 	DBX_DBFUN_END(baton->c);
 
-   dbx_destroy_baton(baton, baton->pmeth);
    dbx_request_memory_free(baton->pmeth->pcon, baton->pmeth, 0);
+   dbx_destroy_baton(baton, baton->pmeth);
 
-   delete req;
    return;
 }
 
@@ -705,6 +1168,12 @@ void DBX_DBNAME::LogMessage(const FunctionCallbackInfo<Value>& args)
    if (message && title) {
       dbx_log_event(pcon, message, title, 0);
    }
+   if (message) {
+      dbx_free((void *) message, 0);
+   }
+   if (title) {
+      dbx_free((void *) title, 0);
+   }
 
    result = dbx_new_string8(isolate, (char *) "", pcon->utf8);
    args.GetReturnValue().Set(result);
@@ -905,6 +1374,66 @@ void DBX_DBNAME::Open(const FunctionCallbackInfo<Value>& args)
             p = p2 + 1;
          }
       }
+      else if (!strcmp(name, (char *) "pool_size") || !strcmp(name, (char *) "pool")) { /* v2.1.20 */
+         pcon->pool_size = DBX_INT32_VALUE(DBX_GET(obj, key));
+      }
+      else if (!strcmp(name, (char *) "pool_min")) { /* v2.1.20 */
+         pcon->pool_min = DBX_INT32_VALUE(DBX_GET(obj, key));
+      }
+      else if (!strcmp(name, (char *) "shared")) { /* v2.1.20 */
+         if (DBX_GET(obj, key)->IsBoolean()) {
+            pcon->shared = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+         }
+      }
+      else if (!strcmp(name, (char *) "pipeline")) { /* v2.1.20 */
+         if (DBX_GET(obj, key)->IsBoolean()) {
+            pcon->pipeline = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+         }
+      }
+      else if (!strcmp(name, (char *) "transport")) { /* v2.1.20 */
+         char transport[32];
+
+         transport[0] = '\0';
+         value = DBX_TO_STRING(DBX_GET(obj, key));
+         if (dbx_string8_length(isolate, value, 0) < 16) {
+            DBX_WRITE_UTF8(value, transport);
+            dbx_lcase(transport);
+         }
+         if (!strcmp(transport, "uv"))
+            pcon->transport = DBX_TRANSPORT_UV;
+         else
+            pcon->transport = DBX_TRANSPORT_THREADS;
+      }
+      else if (!strcmp(name, (char *) "long_threads")) { /* v2.1.20 */
+         pcon->long_threads = DBX_INT32_VALUE(DBX_GET(obj, key));
+      }
+      else if (!strcmp(name, (char *) "coalesce")) { /* v2.1.20 */
+         if (DBX_GET(obj, key)->IsBoolean()) {
+            pcon->coalesce = DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsTrue() ? 1 : 0;
+         }
+      }
+      else if (!strcmp(name, (char *) "max_inflight")) { /* v2.1.20 */
+         pcon->max_inflight = DBX_INT32_VALUE(DBX_GET(obj, key));
+      }
+      else if (!strcmp(name, (char *) "max_queue")) { /* v2.1.20 */
+         pcon->max_queue = DBX_INT32_VALUE(DBX_GET(obj, key));
+      }
+      else if (!strcmp(name, (char *) "overflow")) { /* v2.1.20 */
+         char overflow[32];
+
+         overflow[0] = '\0';
+         value = DBX_TO_STRING(DBX_GET(obj, key));
+         if (dbx_string8_length(isolate, value, 0) < 16) {
+            DBX_WRITE_UTF8(value, overflow);
+            dbx_lcase(overflow);
+         }
+         if (!strcmp(overflow, "block"))
+            pcon->overflow = DBX_OVERFLOW_BLOCK;
+         else if (!strcmp(overflow, "queue"))
+            pcon->overflow = DBX_OVERFLOW_QUEUE;
+         else
+            pcon->overflow = DBX_OVERFLOW_REJECT;
+      }
       else if (!strcmp(name, (char *) "multithreaded")) {
         if (DBX_GET(obj, key)->IsBoolean()) {
             if (DBX_TO_BOOLEAN(DBX_GET(obj, key))->IsFalse()) { /* v2.1.17 */
@@ -974,11 +1503,13 @@ void DBX_DBNAME::Open(const FunctionCallbackInfo<Value>& args)
       rc = dbx_open(pmeth);
       if (rc == CACHE_SUCCESS) {
          c->open = 1;
+#if !defined(_WIN32)
+         dbx_uv_open(pcon, isolate); /* v2.1.20 */
+#endif
       }
+      dbx_request_error(pmeth); /* v2.1.20 */
 
-      Local<Function> cb = Local<Function>::Cast(args[js_narg]);
-
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, js_narg); /* v2.1.20 */
 
       c->Ref();
 
@@ -986,7 +1517,7 @@ void DBX_DBNAME::Open(const FunctionCallbackInfo<Value>& args)
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -997,6 +1528,9 @@ void DBX_DBNAME::Open(const FunctionCallbackInfo<Value>& args)
 
    if (rc == CACHE_SUCCESS) {
       c->open = 1; 
+#if !defined(_WIN32)
+      dbx_uv_open(pcon, isolate); /* v2.1.20 */
+#endif
    }
 
    Local<String> result = dbx_new_string8(isolate, pcon->error, 0);
@@ -1038,26 +1572,29 @@ void DBX_DBNAME::Close(const FunctionCallbackInfo<Value>& args)
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_do_nothing;
 
+      dbx_admit_flush(c); /* v2.1.20 */
       dbx_close(baton->pmeth);
+      dbx_request_error(baton->pmeth); /* v2.1.20 */
 
-      Local<Function> cb = Local<Function>::Cast(args[js_narg]);
-
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, js_narg); /* v2.1.20 */
 
       c->Ref();
 
-      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
+      if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, DBX_TASK_NO_ADMISSION)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
-
+#if !defined(_WIN32)
+      dbx_async_close(pcon); /* v2.1.20 */
+#endif
       return;
    }
 
+   dbx_admit_flush(c); /* v2.1.20 */
    dbx_close(pmeth);
 
 Close_Exit:
@@ -1065,6 +1602,10 @@ Close_Exit:
    Local<String> result = dbx_new_string8(isolate, pcon->error, 0);
 
    dbx_request_memory_free(pcon, pmeth, 0);
+   dbx_request_memory_pool_free(pcon); /* v2.1.20 */
+#if !defined(_WIN32)
+   dbx_async_close(pcon);
+#endif
 
    args.GetReturnValue().Set(result);
 }
@@ -1102,6 +1643,7 @@ void DBX_DBNAME::Namespace(const FunctionCallbackInfo<Value>& args)
    if (pmeth->argc > 0) {
       result = DBX_TO_STRING(args[0]);
       dbx_ibuffer_add(pmeth, isolate, 0, result, NULL, 0, 0);
+      dbx_coalesce_reset(c); /* v2.1.20 */
    }
 
    if (pcon->log_transmissions) {
@@ -1112,9 +1654,7 @@ void DBX_DBNAME::Namespace(const FunctionCallbackInfo<Value>& args)
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_namespace;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
 
       c->Ref();
 
@@ -1123,7 +1663,8 @@ void DBX_DBNAME::Namespace(const FunctionCallbackInfo<Value>& args)
 
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
+         dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
       return;
@@ -1206,8 +1747,8 @@ int DBX_DBNAME::LogFunction(DBX_DBNAME *c, const FunctionCallbackInfo<Value>& ar
 
 int DBX_DBNAME::GlobalReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>& args, DBXMETH *pmeth, DBXGREF *pgref, short context)
 {
-   int n, nx, rc, otype, len;
-   char *p;
+   int n, nx, rc, otype;
+   long long int64;
    char buffer[64];
    DBXVAL *pval;
    Local<Object> obj;
@@ -1216,6 +1757,9 @@ int DBX_DBNAME::GlobalReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>
    DBXCON *pcon = pmeth->pcon;
 
    pmeth->ibuffer_used = 0;
+   if (pmeth->iov_n) { /* v2.1.20 */
+      dbx_ibuffer_release(pmeth);
+   }
    pmeth->cargc = 0;
    rc = 0;
 
@@ -1226,6 +1770,22 @@ int DBX_DBNAME::GlobalReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>
    pmeth->output_val.svalue.len_used = 0;
    nx = 0;
    n = 0;
+
+   /* v2.1.20 the global name and fixed subscripts of an mglobal object are pre-encoded */
+   if (pgref && pgref->pprefix && !pmeth->lock && (nx = dbx_global_prefix_add(pmeth, pgref->pprefix))) {
+      if (pcon->dbtype != DBX_DBTYPE_YOTTADB && context == 0) {
+         if (pmeth->args[0].svalue.buf_addr[0] == '^')
+            rc = pcon->p_isc_so->p_CachePushGlobal((int) pmeth->args[0].svalue.len_used - 1, (Callin_char_t *) pmeth->args[0].svalue.buf_addr + 1);
+         else
+            rc = pcon->p_isc_so->p_CachePushGlobal((int) pmeth->args[0].svalue.len_used, (Callin_char_t *) pmeth->args[0].svalue.buf_addr);
+         for (n = 1; n < nx; n ++) {
+            rc = dbx_reference(pmeth, n);
+         }
+         n = 0;
+      }
+      goto GlobalReference_args;
+   }
+
    pmeth->args[nx].cvalue.pstr = 0;
    if (pgref) {
       dbx_ibuffer_add(pmeth, isolate, nx, str, pgref->global, (int) strlen(pgref->global), 0);
@@ -1251,13 +1811,10 @@ int DBX_DBNAME::GlobalReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>
    nx ++;
 
    if (pgref && (pval = pgref->pkey)) {
-      while (pval) {
+      while (pval && DBX_ARGS_RESERVE(pmeth, nx)) {
          pmeth->args[nx].cvalue.pstr = 0;
          if (pval->type == DBX_DTYPE_INT) {
-            pmeth->args[nx].type = DBX_DTYPE_INT;
-            pmeth->args[nx].num.int32 = (int) pval->num.int32;
-            T_SPRINTF(buffer, _dbxso(buffer), "%d", pval->num.int32);
-            dbx_ibuffer_add(pmeth, isolate, nx, str, buffer, (int) strlen(buffer), 0);
+            dbx_ibuffer_add_int(pmeth, nx, (long long) pval->num.int32, DBX_DTYPE_INT); /* v2.1.20 */
          }
          else {
             dbx_ibuffer_add(pmeth, isolate, nx, str, pval->svalue.buf_addr, (int) pval->svalue.len_used, 0);
@@ -1282,24 +1839,24 @@ int DBX_DBNAME::GlobalReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>
       }
    }
 
-   for (; n < pmeth->argc; n ++, nx ++) {
+GlobalReference_args:
+
+   for (; n < pmeth->argc && DBX_ARGS_RESERVE(pmeth, nx); n ++, nx ++) {
 
       pmeth->args[nx].cvalue.pstr = 0;
 
-      if (args[n]->IsInt32()) {
-         pmeth->args[nx].num.int32 = (int) DBX_INT32_VALUE(args[n]);
-         T_SPRINTF(buffer, _dbxso(buffer), "%d", pmeth->args[nx].num.int32);
-         dbx_ibuffer_add(pmeth, isolate, nx, str, buffer, (int) strlen(buffer), 0);
-         pmeth->args[nx].type = DBX_DTYPE_INT;
+      if (args[n]->IsInt32()) { /* v2.1.20 */
+         dbx_ibuffer_add_int(pmeth, nx, (long long) DBX_INT32_VALUE(args[n]), DBX_DTYPE_INT);
+      }
+      else if (args[n]->IsNumber() && dbx_is_integer(DBX_NUMBER_VALUE(args[n]), &int64)) {
+         dbx_ibuffer_add_int(pmeth, nx, int64, DBX_DTYPE_INT64);
       }
       else {
          pmeth->args[nx].type = DBX_DTYPE_STR;
          obj = dbx_is_object(args[n], &otype);
 
          if (otype == 2) {
-            p = node::Buffer::Data(obj);
-            len = (int) node::Buffer::Length(obj);
-            dbx_ibuffer_add(pmeth, isolate, nx, str, p, (int) len, 0);
+            dbx_ibuffer_add_buffer(pmeth, isolate, nx, obj, 0); /* v2.1.20 */
          }
          else {
             str = DBX_TO_STRING(args[n]);
@@ -1394,9 +1951,7 @@ void DBX_DBNAME::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_get;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
 
       c->Ref();
 
@@ -1405,7 +1960,7 @@ void DBX_DBNAME::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
 
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -1436,7 +1991,7 @@ void DBX_DBNAME::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
    DBX_DB_UNLOCK(rc);
 
    if (binary) {
-      Local<Object> bx = node::Buffer::New(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+      Local<Object> bx = dbx_new_buffer(isolate, pmeth);
       args.GetReturnValue().Set(bx);
    }
    else {
@@ -1491,14 +2046,13 @@ void DBX_DBNAME::Set(const FunctionCallbackInfo<Value>& args)
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_set;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       c->Ref();
       if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -1575,14 +2129,13 @@ void DBX_DBNAME::Defined(const FunctionCallbackInfo<Value>& args)
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_defined;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       c->Ref();
       if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -1660,14 +2213,13 @@ void DBX_DBNAME::Delete(const FunctionCallbackInfo<Value>& args)
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_delete;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       c->Ref();
       if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -1744,14 +2296,13 @@ void DBX_DBNAME::Next(const FunctionCallbackInfo<Value>& args)
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_next;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       c->Ref();
       if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -1827,14 +2378,13 @@ void DBX_DBNAME::Previous(const FunctionCallbackInfo<Value>& args)
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_previous;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       c->Ref();
       if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -1912,14 +2462,13 @@ void DBX_DBNAME::Increment(const FunctionCallbackInfo<Value>& args)
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_increment;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       c->Ref();
       if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -1998,14 +2547,13 @@ void DBX_DBNAME::Lock(const FunctionCallbackInfo<Value>& args)
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_lock;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       c->Ref();
       if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -2109,14 +2657,13 @@ void DBX_DBNAME::Unlock(const FunctionCallbackInfo<Value>& args)
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_unlock;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       c->Ref();
       if (dbx_queue_task((void *) dbx_process_task, (void *) dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -2188,6 +2735,7 @@ void DBX_DBNAME::MGlobal(const FunctionCallbackInfo<Value>& args)
 
    gx->c = c;
    gx->pkey = NULL;
+   gx->pprefix = NULL; /* v2.1.20 */
 
    /* 1.4.10 */
    rc = dbx_global_reset(args, isolate, pcon, pmeth, (void *) gx, 0, 0);
@@ -2319,8 +2867,7 @@ void DBX_DBNAME::MGlobalQuery_Close(const FunctionCallbackInfo<Value>& args)
 
 int DBX_DBNAME::ExtFunctionReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>& args, DBXMETH *pmeth, DBXFREF *pfref, DBXFUN *pfun, short context)
 {
-   int n, nx, rc, otype, len;
-   char *p;
+   int n, nx, rc, otype;
    char buffer[64];
    Local<Object> obj;
    Local<String> str;
@@ -2328,6 +2875,9 @@ int DBX_DBNAME::ExtFunctionReference(DBX_DBNAME *c, const FunctionCallbackInfo<V
    DBXCON *pcon = pmeth->pcon;
 
    pmeth->ibuffer_used = 0;
+   if (pmeth->iov_n) { /* v2.1.20 */
+      dbx_ibuffer_release(pmeth);
+   }
    rc = 0;
 
    if (!context) {
@@ -2364,7 +2914,7 @@ int DBX_DBNAME::ExtFunctionReference(DBX_DBNAME *c, const FunctionCallbackInfo<V
 
    nx ++;
 
-   for (; n < pmeth->argc; n ++, nx ++) {
+   for (; n < pmeth->argc && DBX_ARGS_RESERVE(pmeth, nx); n ++, nx ++) {
 
       pmeth->args[nx].cvalue.pstr = 0;
 
@@ -2379,9 +2929,7 @@ int DBX_DBNAME::ExtFunctionReference(DBX_DBNAME *c, const FunctionCallbackInfo<V
          obj = dbx_is_object(args[n], &otype);
 
          if (otype == 2) {
-            p = node::Buffer::Data(obj);
-            len = (int) node::Buffer::Length(obj);
-            dbx_ibuffer_add(pmeth, isolate, nx, str, p, (int) len, 1);
+            dbx_ibuffer_add_buffer(pmeth, isolate, nx, obj, 1); /* v2.1.20 */
          }
          else {
             str = DBX_TO_STRING(args[n]);
@@ -2454,9 +3002,7 @@ void DBX_DBNAME::ExtFunctionEx(const FunctionCallbackInfo<Value>& args, int bina
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_function;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
 
       c->Ref();
 
@@ -2465,7 +3011,7 @@ void DBX_DBNAME::ExtFunctionEx(const FunctionCallbackInfo<Value>& args, int bina
 
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -2493,7 +3039,7 @@ void DBX_DBNAME::ExtFunctionEx(const FunctionCallbackInfo<Value>& args, int bina
    DBX_DB_UNLOCK(rc);
 
    if (binary) {
-      Local<Object> bx = node::Buffer::New(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+      Local<Object> bx = dbx_new_buffer(isolate, pmeth);
       args.GetReturnValue().Set(bx);
    }
    else {
@@ -2507,8 +3053,7 @@ void DBX_DBNAME::ExtFunctionEx(const FunctionCallbackInfo<Value>& args, int bina
 
 int DBX_DBNAME::ClassReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>& args, DBXMETH *pmeth, DBXCREF *pcref, int argc_offset, short context)
 {
-   int n, nx, rc, otype, fc, mn, len;
-   char *p;
+   int n, nx, rc, otype, fc, mn;
    char buffer[64];
    Local<Object> obj;
    Local<String> str;
@@ -2517,6 +3062,9 @@ int DBX_DBNAME::ClassReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>&
    DBXCON *pcon = pmeth->pcon;
 
    pmeth->ibuffer_used = 0;
+   if (pmeth->iov_n) { /* v2.1.20 */
+      dbx_ibuffer_release(pmeth);
+   }
    pmeth->cargc = 0;
    rc = 0;
 
@@ -2570,7 +3118,7 @@ int DBX_DBNAME::ClassReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>&
       }
    }
 
-   for (; n < pmeth->argc; n ++, nx ++) {
+   for (; n < pmeth->argc && DBX_ARGS_RESERVE(pmeth, nx); n ++, nx ++) {
 
       pmeth->args[nx].cvalue.pstr = 0;
 
@@ -2586,9 +3134,7 @@ int DBX_DBNAME::ClassReference(DBX_DBNAME *c, const FunctionCallbackInfo<Value>&
          obj = dbx_is_object(args[n], &otype);
 
          if (otype == 2) {
-            p = node::Buffer::Data(obj);
-            len = (int) node::Buffer::Length(obj);
-            dbx_ibuffer_add(pmeth, isolate, nx, str, p, (int) len, 0);
+            dbx_ibuffer_add_buffer(pmeth, isolate, nx, obj, 0); /* v2.1.20 */
          }
          else {
             clx = NULL;
@@ -2690,9 +3236,7 @@ void DBX_DBNAME::ClassMethodEx(const FunctionCallbackInfo<Value>& args, int bina
       dbx_baton_t *baton = dbx_make_baton(c, pmeth);
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_classmethod;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
 
       c->Ref();
 
@@ -2701,7 +3245,7 @@ void DBX_DBNAME::ClassMethodEx(const FunctionCallbackInfo<Value>& args, int bina
 
          T_STRCPY(error, _dbxso(error), pcon->error);
          dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -2729,7 +3273,7 @@ void DBX_DBNAME::ClassMethodEx(const FunctionCallbackInfo<Value>& args, int bina
 
    if (pmeth->output_val.type != DBX_DTYPE_OREF) {
       if (binary) {
-         Local<Object> bx = node::Buffer::New(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+         Local<Object> bx = dbx_new_buffer(isolate, pmeth);
          args.GetReturnValue().Set(bx);
       }
       else {
@@ -2868,6 +3412,311 @@ void DBX_DBNAME::Sleep(const FunctionCallbackInfo<Value>& args)
 }
 
 
+/* v2.1.20 */
+void DBX_DBNAME::MemStats(const FunctionCallbackInfo<Value>& args)
+{
+   int n;
+   DBXCON *pcon;
+   DBXMEMSTATS stats;
+   Local<String> key;
+   Local<Object> result, pool, alloc, tags, tag;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ICONTEXT;
+   c->dbx_count ++;
+
+   pcon = c->pcon;
+
+   result = DBX_OBJECT_NEW();
+   pool = DBX_OBJECT_NEW();
+
+   key = dbx_new_string8(isolate, (char *) "idle", 0);
+   DBX_SET(pool, key, DBX_INTEGER_NEW(pcon->pmeth_pool_idle));
+   key = dbx_new_string8(isolate, (char *) "max", 0);
+   DBX_SET(pool, key, DBX_INTEGER_NEW(pcon->pmeth_pool_max));
+   key = dbx_new_string8(isolate, (char *) "hits", 0);
+   DBX_SET(pool, key, DBX_NUMBER_NEW((double) pcon->pmeth_pool_hits));
+   key = dbx_new_string8(isolate, (char *) "misses", 0);
+   DBX_SET(pool, key, DBX_NUMBER_NEW((double) pcon->pmeth_pool_misses));
+
+   key = dbx_new_string8(isolate, (char *) "request_pool", 0);
+   DBX_SET(result, key, pool);
+
+   /* process-wide allocator statistics */
+   dbx_mem_stats(&stats);
+   alloc = DBX_OBJECT_NEW();
+
+   key = dbx_new_string8(isolate, (char *) "hits", 0);
+   DBX_SET(alloc, key, DBX_NUMBER_NEW((double) stats.class_hits));
+   key = dbx_new_string8(isolate, (char *) "misses", 0);
+   DBX_SET(alloc, key, DBX_NUMBER_NEW((double) stats.class_misses));
+   key = dbx_new_string8(isolate, (char *) "idle_bytes", 0);
+   DBX_SET(alloc, key, DBX_NUMBER_NEW((double) stats.class_idle_bytes));
+
+   tags = DBX_OBJECT_NEW();
+   for (n = 0; n < DBX_MEM_TAGS; n ++) {
+      if (!stats.tags[n].allocs) {
+         continue;
+      }
+      tag = DBX_OBJECT_NEW();
+      key = dbx_new_string8(isolate, (char *) "count", 0);
+      DBX_SET(tag, key, DBX_NUMBER_NEW((double) stats.tags[n].count));
+      key = dbx_new_string8(isolate, (char *) "bytes", 0);
+      DBX_SET(tag, key, DBX_NUMBER_NEW((double) stats.tags[n].bytes));
+      key = dbx_new_string8(isolate, (char *) "bytes_peak", 0);
+      DBX_SET(tag, key, DBX_NUMBER_NEW((double) stats.tags[n].bytes_peak));
+      key = dbx_new_string8(isolate, (char *) "allocs", 0);
+      DBX_SET(tag, key, DBX_NUMBER_NEW((double) stats.tags[n].allocs));
+      key = dbx_new_string8(isolate, (char *) dbx_mem_tag_name(n), 0);
+      DBX_SET(tags, key, tag);
+   }
+   key = dbx_new_string8(isolate, (char *) "tags", 0);
+   DBX_SET(alloc, key, tags);
+
+   key = dbx_new_string8(isolate, (char *) "allocator", 0);
+   DBX_SET(result, key, alloc);
+
+   args.GetReturnValue().Set(result);
+}
+
+
+/* v2.1.20 */
+void DBX_DBNAME::PoolStats(const FunctionCallbackInfo<Value>& args)
+{
+   DBXCON *pcon;
+   Local<String> key;
+   Local<Object> result;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ICONTEXT;
+   c->dbx_count ++;
+
+   pcon = c->pcon;
+
+   result = DBX_OBJECT_NEW();
+
+#if !defined(_WIN32)
+   if (pcon->ppool) {
+      int lane;
+      DBXPOOL *ppool = (DBXPOOL *) pcon->ppool;
+      DBXPOOLLANE *plane;
+      Local<Object> lanes, lane_obj;
+      unsigned long enqueue_pos, dequeue_pos, depth, depth_all, depth_peak_all;
+      unsigned long long tasks, wait_ns_total, wait_ns_max, tasks_all, wait_ns_total_all, wait_ns_max_all;
+
+      /* v2.1.20 the figures for each lane, and for the pool as a whole */
+      lanes = DBX_OBJECT_NEW();
+      depth_all = 0;
+      depth_peak_all = 0;
+      tasks_all = 0;
+      wait_ns_total_all = 0;
+      wait_ns_max_all = 0;
+      for (lane = 0; lane < DBX_POOL_LANES; lane ++) {
+         plane = &(ppool->lane[lane]);
+         dequeue_pos = __atomic_load_n(&(plane->dequeue_pos), __ATOMIC_RELAXED);
+         enqueue_pos = __atomic_load_n(&(plane->enqueue_pos), __ATOMIC_RELAXED);
+         depth = (enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0);
+         tasks = __atomic_load_n(&(plane->tasks), __ATOMIC_RELAXED);
+         wait_ns_total = __atomic_load_n(&(plane->wait_ns_total), __ATOMIC_RELAXED);
+         wait_ns_max = __atomic_load_n(&(plane->wait_ns_max), __ATOMIC_RELAXED);
+
+         lane_obj = DBX_OBJECT_NEW();
+         key = dbx_new_string8(isolate, (char *) "depth", 0);
+         DBX_SET(lane_obj, key, DBX_NUMBER_NEW((double) depth));
+         key = dbx_new_string8(isolate, (char *) "depth_peak", 0);
+         DBX_SET(lane_obj, key, DBX_NUMBER_NEW((double) __atomic_load_n(&(plane->depth_peak), __ATOMIC_RELAXED)));
+         key = dbx_new_string8(isolate, (char *) "tasks", 0);
+         DBX_SET(lane_obj, key, DBX_NUMBER_NEW((double) tasks));
+         key = dbx_new_string8(isolate, (char *) "wait_us_mean", 0);
+         DBX_SET(lane_obj, key, DBX_NUMBER_NEW(tasks ? ((double) wait_ns_total / (double) tasks) / 1000.0 : 0.0));
+         key = dbx_new_string8(isolate, (char *) "wait_us_max", 0);
+         DBX_SET(lane_obj, key, DBX_NUMBER_NEW((double) wait_ns_max / 1000.0));
+         key = dbx_new_string8(isolate, (char *) (lane == DBX_LANE_LONG ? "long" : "short"), 0);
+         DBX_SET(lanes, key, lane_obj);
+
+         depth_all += depth;
+         if (plane->depth_peak > depth_peak_all) {
+            depth_peak_all = plane->depth_peak;
+         }
+         tasks_all += tasks;
+         wait_ns_total_all += wait_ns_total;
+         if (wait_ns_max > wait_ns_max_all) {
+            wait_ns_max_all = wait_ns_max;
+         }
+      }
+
+      key = dbx_new_string8(isolate, (char *) "threads", 0);
+      DBX_SET(result, key, DBX_INTEGER_NEW(__atomic_load_n(&(ppool->size), __ATOMIC_RELAXED)));
+      key = dbx_new_string8(isolate, (char *) "threads_max", 0);
+      DBX_SET(result, key, DBX_INTEGER_NEW(ppool->size_max));
+      key = dbx_new_string8(isolate, (char *) "reconnects", 0);
+      DBX_SET(result, key, DBX_NUMBER_NEW((double) __atomic_load_n(&(ppool->reconnects), __ATOMIC_RELAXED)));
+      key = dbx_new_string8(isolate, (char *) "long_threads", 0);
+      DBX_SET(result, key, DBX_INTEGER_NEW(ppool->long_max < ppool->size ? ppool->long_max : ppool->size));
+      key = dbx_new_string8(isolate, (char *) "capacity", 0);
+      DBX_SET(result, key, DBX_NUMBER_NEW((double) (ppool->lane[DBX_LANE_SHORT].queue_mask + 1)));
+      key = dbx_new_string8(isolate, (char *) "depth", 0);
+      DBX_SET(result, key, DBX_NUMBER_NEW((double) depth_all));
+      key = dbx_new_string8(isolate, (char *) "depth_peak", 0);
+      DBX_SET(result, key, DBX_NUMBER_NEW((double) depth_peak_all));
+      key = dbx_new_string8(isolate, (char *) "tasks", 0);
+      DBX_SET(result, key, DBX_NUMBER_NEW((double) tasks_all));
+      key = dbx_new_string8(isolate, (char *) "wait_us_mean", 0);
+      DBX_SET(result, key, DBX_NUMBER_NEW(tasks_all ? ((double) wait_ns_total_all / (double) tasks_all) / 1000.0 : 0.0));
+      key = dbx_new_string8(isolate, (char *) "wait_us_max", 0);
+      DBX_SET(result, key, DBX_NUMBER_NEW((double) wait_ns_max_all / 1000.0));
+      key = dbx_new_string8(isolate, (char *) "lanes", 0);
+      DBX_SET(result, key, lanes);
+   }
+   if (pcon->pbroker) {
+      key = dbx_new_string8(isolate, (char *) "shared", 0);
+      DBX_SET(result, key, DBX_INTEGER_NEW(((DBXBROKER *) pcon->pbroker)->refs));
+   }
+   if (pcon->ppipe) { /* v2.1.20 */
+      NETXPIPE *ppipe = (NETXPIPE *) pcon->ppipe;
+      Local<Object> pipe_obj = DBX_OBJECT_NEW();
+
+      pthread_mutex_lock(&(ppipe->mutex));
+      key = dbx_new_string8(isolate, (char *) "inflight", 0);
+      DBX_SET(pipe_obj, key, DBX_INTEGER_NEW(ppipe->inflight));
+      key = dbx_new_string8(isolate, (char *) "inflight_peak", 0);
+      DBX_SET(pipe_obj, key, DBX_INTEGER_NEW(ppipe->inflight_peak));
+      key = dbx_new_string8(isolate, (char *) "requests", 0);
+      DBX_SET(pipe_obj, key, DBX_NUMBER_NEW((double) ppipe->requests));
+      key = dbx_new_string8(isolate, (char *) "closed", 0);
+      DBX_SET(pipe_obj, key, DBX_BOOLEAN_NEW(ppipe->closed ? true : false));
+      pthread_mutex_unlock(&(ppipe->mutex));
+      key = dbx_new_string8(isolate, (char *) "pipeline", 0);
+      DBX_SET(result, key, pipe_obj);
+   }
+   if (pcon->puv) { /* v2.1.20 */
+      int n, connections;
+      NETXUV *puv = (NETXUV *) pcon->puv;
+      Local<Object> uv_obj = DBX_OBJECT_NEW();
+
+      connections = 0;
+      for (n = 0; n < puv->size; n ++) {
+         if (!puv->con[n].closed) {
+            connections ++;
+         }
+      }
+      key = dbx_new_string8(isolate, (char *) "connections", 0);
+      DBX_SET(uv_obj, key, DBX_INTEGER_NEW(connections));
+      key = dbx_new_string8(isolate, (char *) "inflight", 0);
+      DBX_SET(uv_obj, key, DBX_INTEGER_NEW(netx_uv_load(puv)));
+      key = dbx_new_string8(isolate, (char *) "inflight_peak", 0);
+      DBX_SET(uv_obj, key, DBX_INTEGER_NEW(puv->inflight_peak));
+      key = dbx_new_string8(isolate, (char *) "requests", 0);
+      DBX_SET(uv_obj, key, DBX_NUMBER_NEW((double) puv->requests));
+      key = dbx_new_string8(isolate, (char *) "lost", 0);
+      DBX_SET(uv_obj, key, DBX_NUMBER_NEW((double) puv->lost));
+      key = dbx_new_string8(isolate, (char *) "uv", 0);
+      DBX_SET(result, key, uv_obj);
+   }
+#endif
+
+   key = dbx_new_string8(isolate, (char *) "coalesced", 0); /* v2.1.20 */
+   DBX_SET(result, key, DBX_NUMBER_NEW((double) pcon->coalesced));
+
+   args.GetReturnValue().Set(result);
+}
+
+
+/* v2.1.20 set the lane ('short' or 'long') for the next request made on the connection; returns the connection object so that the request can follow */
+void DBX_DBNAME::Lane(const FunctionCallbackInfo<Value>& args)
+{
+   char lane[32];
+   Local<String> str;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ICONTEXT;
+   c->dbx_count ++;
+
+   lane[0] = '\0';
+   if (args.Length() > 0) {
+      str = DBX_TO_STRING(args[0]);
+      if (dbx_string8_length(isolate, str, 0) < 16) {
+         DBX_WRITE_UTF8(str, lane);
+         dbx_lcase(lane);
+      }
+   }
+   if (!strcmp(lane, "short"))
+      c->lane_next = DBX_LANE_SHORT;
+   else if (!strcmp(lane, "long"))
+      c->lane_next = DBX_LANE_LONG;
+   else
+      c->lane_next = DBX_LANE_DEFAULT;
+
+   args.GetReturnValue().Set(args.This());
+}
+
+
+/* v2.1.20 admission control: report the state and (optionally) register a function to be told when the connection becomes, or ceases to be, saturated */
+void DBX_DBNAME::Saturation(const FunctionCallbackInfo<Value>& args)
+{
+   DBXCON *pcon;
+   Local<String> key;
+   Local<Object> result;
+   DBX_DBNAME *c = ObjectWrap::Unwrap<DBX_DBNAME>(args.This());
+   DBX_GET_ICONTEXT;
+   c->dbx_count ++;
+
+   pcon = c->pcon;
+
+   if (args.Length() > 0) {
+      if (args[0]->IsFunction()) {
+         c->saturation_cb.Reset(isolate, Local<Function>::Cast(args[0]));
+      }
+      else {
+         c->saturation_cb.Reset();
+      }
+   }
+
+   result = DBX_OBJECT_NEW();
+
+   key = dbx_new_string8(isolate, (char *) "saturated", 0);
+   DBX_SET(result, key, DBX_BOOLEAN_NEW(c->saturated ? true : false));
+   key = dbx_new_string8(isolate, (char *) "inflight", 0);
+#if !defined(_WIN32)
+   DBX_SET(result, key, DBX_INTEGER_NEW(__atomic_load_n(&(pcon->inflight), __ATOMIC_RELAXED)));
+#else
+   DBX_SET(result, key, DBX_INTEGER_NEW(pcon->inflight));
+#endif
+   key = dbx_new_string8(isolate, (char *) "held", 0);
+   DBX_SET(result, key, DBX_INTEGER_NEW(c->admit_held));
+   key = dbx_new_string8(isolate, (char *) "max_inflight", 0);
+   DBX_SET(result, key, DBX_INTEGER_NEW(pcon->max_inflight));
+   key = dbx_new_string8(isolate, (char *) "max_queue", 0);
+   DBX_SET(result, key, DBX_INTEGER_NEW(pcon->max_queue));
+   key = dbx_new_string8(isolate, (char *) "overflow", 0);
+   DBX_SET(result, key, dbx_new_string8(isolate, (char *) (pcon->overflow == DBX_OVERFLOW_BLOCK ? "block" : (pcon->overflow == DBX_OVERFLOW_QUEUE ? "queue" : "reject")), 0));
+   key = dbx_new_string8(isolate, (char *) "rejected", 0);
+   DBX_SET(result, key, DBX_NUMBER_NEW((double) pcon->admit_rejected));
+   key = dbx_new_string8(isolate, (char *) "blocked", 0);
+   DBX_SET(result, key, DBX_NUMBER_NEW((double) pcon->admit_blocked));
+   key = dbx_new_string8(isolate, (char *) "queued", 0);
+   DBX_SET(result, key, DBX_NUMBER_NEW((double) pcon->admit_queued));
+
+   args.GetReturnValue().Set(result);
+}
+
+
+/* v2.1.20 raise the error for a request that could not be queued: requests refused by admission control carry the code EDBXOVERLOAD */
+void dbx_throw_queue_error(Isolate * isolate, DBXCON *pcon, char *error)
+{
+   Local<Context> icontext = isolate->GetCurrentContext();
+   Local<Value> exception = Exception::Error(dbx_new_string8(isolate, error, 1));
+
+   if (pcon->error_code == DBX_ERROR_OVERLOAD) {
+      Local<Object> obj = Local<Object>::Cast(exception);
+
+      DBX_SET(obj, dbx_new_string8(isolate, (char *) "code", 0), dbx_new_string8(isolate, (char *) DBX_CODE_E_OVERLOAD, 0));
+      /* the request never reached the database: do not leave the error behind for requests still in progress */
+      pcon->error_code = 0;
+      pcon->error[0] = '\0';
+   }
+   isolate->ThrowException(exception);
+   return;
+}
+
+
 void DBX_DBNAME::Benchmark(const FunctionCallbackInfo<Value>& args)
 {
 #if 0
@@ -3012,7 +3861,6 @@ NODE_MODULE_INITIALIZER(Local<Object> exports,
 /* v2.1.17 */
 DBXMETH * dbx_request_memory(DBXCON *pcon, short context)
 {
-   int n;
    DBXMETH *pmeth;
 
    pmeth = NULL;
@@ -3021,22 +3869,52 @@ DBXMETH * dbx_request_memory(DBXCON *pcon, short context)
    }
    else {
       if (pcon->use_mutex) {
-         pmeth = dbx_request_memory_alloc(pcon, 0);
+         /* v2.1.20 recycle an idle request block if one is available */
+         pmeth = (DBXMETH *) pcon->pmeth_pool;
+         if (pmeth) {
+            pcon->pmeth_pool = (void *) pmeth->pnext;
+            pcon->pmeth_pool_idle --;
+            pcon->pmeth_pool_hits ++;
+            pmeth->output_val.svalue.buf_addr[0] = '\0';
+            pmeth->output_val.svalue.len_used = 0;
+            pmeth->ibuffer_used = 0;
+            /* v2.1.20 the previous request's argument slots must not be seen by this one */
+            memset((void *) pmeth->args_inline, 0, sizeof(pmeth->args_inline));
+            memset((void *) pmeth->yargs_inline, 0, sizeof(pmeth->yargs_inline));
+         }
+         else {
+            pmeth = dbx_request_memory_alloc(pcon, 0);
+            pcon->pmeth_pool_misses ++;
+         }
       }
       else {
          pmeth = (DBXMETH *) pcon->pmeth_base;
       }
    }
 
+   if (!pmeth) {
+      return NULL;
+   }
+
    pmeth->pcon = pcon;
+   pmeth->pnext = NULL;
    pmeth->binary = 0;
    pmeth->lock = 0;
    pmeth->increment = 0;
    pmeth->done = 0;
-   for (n = 0; n < DBX_MAXARGS; n ++) {
-      pmeth->args[n].cvalue.pstr = NULL;
+   pmeth->lane = DBX_LANE_DEFAULT; /* v2.1.20 */
+   pmeth->error_code = 0; /* v2.1.20 */
+   pmeth->error[0] = '\0';
+   if (pmeth->iov_n) {
+      dbx_ibuffer_release(pmeth);
    }
 
+   /* v2.1.20 start with the inline argument slots: isc_cleanup() only visits slots holding long strings */
+   pmeth->args = pmeth->args_inline;
+   pmeth->yargs = pmeth->yargs_inline;
+   pmeth->args_max = DBX_ARGS_INLINE;
+   pmeth->args_exstr = 0;
+
    return pmeth;
 }
 
@@ -3045,25 +3923,36 @@ DBXMETH * dbx_request_memory_alloc(DBXCON *pcon, short context)
 {
    DBXMETH *pmeth;
 
-   pmeth = (DBXMETH *) dbx_malloc(sizeof(DBXMETH), 0);
+   pmeth = (DBXMETH *) dbx_malloc(sizeof(DBXMETH), 201);
    if (!pmeth) {
       return NULL;
    }
 
-   pmeth->output_val.svalue.buf_addr = (char *) dbx_malloc(32000, 0);
+   pmeth->pnext = NULL;
+   memset((void *) pmeth->args_inline, 0, sizeof(pmeth->args_inline));
+   memset((void *) pmeth->yargs_inline, 0, sizeof(pmeth->yargs_inline));
+   pmeth->args = pmeth->args_inline;
+   pmeth->yargs = pmeth->yargs_inline;
+   pmeth->args_max = DBX_ARGS_INLINE;
+   pmeth->args_exstr = 0;
+   pmeth->args_ext = NULL;
+   pmeth->pwait = NULL;
+   pmeth->iov_n = 0; /* v2.1.20 */
+   pmeth->iov_len = 0;
+   pmeth->output_val.svalue.buf_addr = (char *) dbx_malloc(DBX_OBUFFER_SIZE, 201);
    if (!pmeth->output_val.svalue.buf_addr) {
-      dbx_free((void *) pmeth, 0);
+      dbx_free((void *) pmeth, 201);
       return NULL;
    }
 
-   memset((void *) pmeth->output_val.svalue.buf_addr, 0, 32000);
-   pmeth->output_val.svalue.len_alloc = 32000;
+   memset((void *) pmeth->output_val.svalue.buf_addr, 0, DBX_OBUFFER_SIZE);
+   pmeth->output_val.svalue.len_alloc = DBX_OBUFFER_SIZE;
    pmeth->output_val.svalue.len_used = 0;
 
-   pmeth->ibuffer = (unsigned char *) dbx_malloc(CACHE_MAXSTRLEN + DBX_IBUFFER_OFFSET, 0);
+   pmeth->ibuffer = (unsigned char *) dbx_malloc(CACHE_MAXSTRLEN + DBX_IBUFFER_OFFSET, 201);
    if (!pmeth->ibuffer) {
-      dbx_free((void *) pmeth->output_val.svalue.buf_addr, 0);
-      dbx_free((void *) pmeth, 0);
+      dbx_free((void *) pmeth->output_val.svalue.buf_addr, 201);
+      dbx_free((void *) pmeth, 201);
       return NULL;
    }
 
@@ -3082,16 +3971,157 @@ int dbx_request_memory_free(DBXCON *pcon, DBXMETH *pmeth, short context)
    if (!pmeth) {
       return CACHE_SUCCESS;
    }
-   if (pmeth != (DBXMETH *) pcon->pmeth_base) {
-      if (pmeth->ibuffer) {
-         pmeth->ibuffer -= DBX_IBUFFER_OFFSET;
-         dbx_free((void *) pmeth->ibuffer, 0);
+   if (pmeth->iov_n) { /* v2.1.20 let go of the Buffers sent in place */
+      dbx_ibuffer_release(pmeth);
+   }
+   if (pmeth == (DBXMETH *) pcon->pmeth_base) {
+      return CACHE_SUCCESS;
+   }
+
+   /* v2.1.20 return the block to the connection's free-list rather than releasing it */
+   if (pcon->pmeth_pool_idle >= pcon->pmeth_pool_max || dbx_request_memory_shrink(pmeth) != CACHE_SUCCESS) {
+      dbx_request_memory_release(pmeth);
+      return CACHE_SUCCESS;
+   }
+
+   pmeth->pnext = (DBXMETH *) pcon->pmeth_pool;
+   pcon->pmeth_pool = (void *) pmeth;
+   pcon->pmeth_pool_idle ++;
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 */
+int dbx_request_memory_shrink(DBXMETH *pmeth)
+{
+   unsigned char *p;
+
+   if (pmeth->ibuffer_size > DBX_METH_POOL_HWM) {
+      p = (unsigned char *) dbx_malloc(CACHE_MAXSTRLEN + DBX_IBUFFER_OFFSET, 201);
+      if (!p) {
+         return CACHE_FAILURE;
+      }
+      dbx_free((void *) (pmeth->ibuffer - DBX_IBUFFER_OFFSET), 301);
+      memset((void *) p, 0, DBX_IBUFFER_OFFSET);
+      dbx_add_block_size(p + 5, 0, CACHE_MAXSTRLEN, 0, 0);
+      pmeth->ibuffer = (p + DBX_IBUFFER_OFFSET);
+      pmeth->ibuffer_size = CACHE_MAXSTRLEN;
+   }
+   pmeth->ibuffer_used = 0;
+
+   if (pmeth->output_val.svalue.len_alloc > DBX_METH_POOL_HWM) {
+      p = (unsigned char *) dbx_malloc(DBX_OBUFFER_SIZE, 201);
+      if (!p) {
+         return CACHE_FAILURE;
+      }
+      dbx_free((void *) pmeth->output_val.svalue.buf_addr, 201);
+      pmeth->output_val.svalue.buf_addr = (char *) p;
+      pmeth->output_val.svalue.len_alloc = DBX_OBUFFER_SIZE;
+   }
+   pmeth->output_val.svalue.len_used = 0;
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 grow the output buffer in power-of-two steps: the contents are not preserved */
+int dbx_output_buffer_size(DBXMETH *pmeth, unsigned int size)
+{
+   unsigned int len_alloc;
+   char *p;
+
+   if (size <= pmeth->output_val.svalue.len_alloc) {
+      return CACHE_SUCCESS;
+   }
+
+   len_alloc = 32768;
+   while (len_alloc < size) {
+      if (len_alloc > 0x40000000) {
+         return CACHE_FAILURE;
       }
-      if (pmeth->output_val.svalue.buf_addr) {
-         dbx_free((void *) pmeth->output_val.svalue.buf_addr, 0);
+      len_alloc <<= 1;
+   }
+
+   p = (char *) dbx_malloc((int) len_alloc, 301);
+   if (!p) {
+      return CACHE_FAILURE;
+   }
+   dbx_free((void *) pmeth->output_val.svalue.buf_addr, 301);
+   pmeth->output_val.svalue.buf_addr = p;
+   pmeth->output_val.svalue.len_alloc = len_alloc;
+   pmeth->output_val.svalue.len_used = 0;
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 move the argument descriptors to a heap extension that holds DBX_MAXARGS entries */
+int dbx_request_args(DBXMETH *pmeth, int argc)
+{
+   unsigned char *p;
+
+   if (argc <= pmeth->args_max) {
+      return CACHE_SUCCESS;
+   }
+   if (argc > DBX_MAXARGS) {
+      return CACHE_FAILURE;
+   }
+
+   if (!pmeth->args_ext) {
+      pmeth->args_ext = dbx_malloc((int) (DBX_MAXARGS * (sizeof(DBXVAL) + sizeof(ydb_buffer_t))), 201);
+      if (!pmeth->args_ext) {
+         return CACHE_FAILURE;
       }
-      dbx_free((void *) pmeth, 0);
    }
+
+   p = (unsigned char *) pmeth->args_ext;
+   memcpy((void *) p, (void *) pmeth->args, sizeof(DBXVAL) * pmeth->args_max);
+   memcpy((void *) (p + (DBX_MAXARGS * sizeof(DBXVAL))), (void *) pmeth->yargs, sizeof(ydb_buffer_t) * pmeth->args_max);
+   /* the slots above the inline ones are cleared: a recycled extension still holds an earlier request's arguments */
+   memset((void *) (p + (pmeth->args_max * sizeof(DBXVAL))), 0, sizeof(DBXVAL) * (DBX_MAXARGS - pmeth->args_max));
+   memset((void *) (p + (DBX_MAXARGS * sizeof(DBXVAL)) + (pmeth->args_max * sizeof(ydb_buffer_t))), 0, sizeof(ydb_buffer_t) * (DBX_MAXARGS - pmeth->args_max));
+   pmeth->args = (DBXVAL *) p;
+   pmeth->yargs = (ydb_buffer_t *) (p + (DBX_MAXARGS * sizeof(DBXVAL)));
+   pmeth->args_max = DBX_MAXARGS;
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 */
+int dbx_request_memory_release(DBXMETH *pmeth)
+{
+   if (pmeth->args_ext) {
+      dbx_free((void *) pmeth->args_ext, 201);
+   }
+   if (pmeth->ibuffer) {
+      pmeth->ibuffer -= DBX_IBUFFER_OFFSET;
+      dbx_free((void *) pmeth->ibuffer, 201);
+   }
+   if (pmeth->output_val.svalue.buf_addr) {
+      dbx_free((void *) pmeth->output_val.svalue.buf_addr, 201);
+   }
+   dbx_free((void *) pmeth, 201);
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 */
+int dbx_request_memory_pool_free(DBXCON *pcon)
+{
+   DBXMETH *pmeth, *pmeth_next;
+
+   pmeth = (DBXMETH *) pcon->pmeth_pool;
+   while (pmeth) {
+      pmeth_next = pmeth->pnext;
+      dbx_request_memory_release(pmeth);
+      pmeth = pmeth_next;
+   }
+   pcon->pmeth_pool = NULL;
+   pcon->pmeth_pool_idle = 0;
+
    return CACHE_SUCCESS;
 }
 
@@ -3137,26 +4167,60 @@ void dbx_set_prototype_method(v8::Handle<v8::FunctionTemplate> t, v8::FunctionCa
 }
 
 
-v8::Local<v8::Object> dbx_is_object(v8::Local<v8::Value> value, int *otype)
-{
 #if DBX_NODE_VERSION >= 100000
+/* v2.1.20 <name>Async: the method is called with a Promise taking the place of the callback */
+void dbx_set_prototype_promise(v8::Local<v8::FunctionTemplate> t, v8::FunctionCallback callback, const char* name)
+{
+   char fname[64];
    v8::Isolate* isolate = v8::Isolate::GetCurrent();
-   v8::Local<v8::Context> icontext = isolate->GetCurrentContext();
-#endif
-   *otype = 0;
+   v8::HandleScope handle_scope(isolate);
+   v8::Local<v8::Signature> s = v8::Signature::New(isolate, t);
 
-   if (value->IsObject()) {
-      *otype = 1;
-      v8::Local<v8::Object> value_obj = DBX_TO_OBJECT(value);
-      if (node::Buffer::HasInstance(value_obj)) {
-         *otype = 2;
-      }
-      return value_obj;
-   }
-   else {
-      return v8::Local<v8::Object>::Cast(value);
-   }
-}
+   T_SPRINTF(fname, _dbxso(fname), "%sAsync", name);
+
+   v8::Local<v8::FunctionTemplate> tx = v8::FunctionTemplate::New(isolate, dbx_promise_method, v8::External::New(isolate, (void *) callback), s);
+   v8::Local<v8::String> fn_name = String::NewFromUtf8(isolate, fname, NewStringType::kNormal).ToLocalChecked();
+
+   tx->SetClassName(fn_name);
+   t->PrototypeTemplate()->Set(fn_name, tx);
+
+   return;
+}
+
+
+void dbx_promise_method(const v8::FunctionCallbackInfo<v8::Value>& args)
+{
+   v8::FunctionCallback callback = (v8::FunctionCallback) v8::Local<v8::External>::Cast(args.Data())->Value();
+
+   dbx_promise_call = 1;
+   callback(args);
+   dbx_promise_call = 0;
+
+   return;
+}
+#endif
+
+
+v8::Local<v8::Object> dbx_is_object(v8::Local<v8::Value> value, int *otype)
+{
+#if DBX_NODE_VERSION >= 100000
+   v8::Isolate* isolate = v8::Isolate::GetCurrent();
+   v8::Local<v8::Context> icontext = isolate->GetCurrentContext();
+#endif
+   *otype = 0;
+
+   if (value->IsObject()) {
+      *otype = 1;
+      v8::Local<v8::Object> value_obj = DBX_TO_OBJECT(value);
+      if (node::Buffer::HasInstance(value_obj)) {
+         *otype = 2;
+      }
+      return value_obj;
+   }
+   else {
+      return v8::Local<v8::Object>::Cast(value);
+   }
+}
 
 
 int dbx_string8_length(v8::Isolate * isolate, v8::Local<v8::String> str, int utf8)
@@ -3210,6 +4274,33 @@ v8::Local<v8::String> dbx_new_string8n(v8::Isolate * isolate, char * buffer, uns
 }
 
 
+/* v2.1.20 */
+static void dbx_buffer_free_callback(char *data, void *hint)
+{
+   dbx_free((void *) data, 301);
+}
+
+
+/* v2.1.20 A large result is handed to V8 in its output buffer and the request block gets a fresh default-sized buffer: small results are copied so that V8 does not keep a grown buffer alive for a few bytes */
+v8::Local<v8::Object> dbx_new_buffer(v8::Isolate * isolate, DBXMETH *pmeth)
+{
+   char *p;
+
+   if (pmeth->output_val.svalue.len_used > (DBX_OBUFFER_SIZE / 2)) {
+      p = (char *) dbx_malloc(DBX_OBUFFER_SIZE, 201);
+      if (p) {
+         v8::Local<v8::Object> bx = node::Buffer::New(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used, dbx_buffer_free_callback, NULL).ToLocalChecked();
+         pmeth->output_val.svalue.buf_addr = p;
+         pmeth->output_val.svalue.len_alloc = DBX_OBUFFER_SIZE;
+         pmeth->output_val.svalue.len_used = 0;
+         return bx;
+      }
+   }
+
+   return node::Buffer::Copy(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+}
+
+
 int dbx_write_char8(v8::Isolate * isolate, v8::Local<v8::String> str, char * buffer, int utf8)
 {
    if (utf8) {
@@ -3231,6 +4322,10 @@ int dbx_ibuffer_add(DBXMETH *pmeth, v8::Isolate * isolate, int argn, v8::Local<v
 __try {
 #endif
 
+   if (!DBX_ARGS_RESERVE(pmeth, argn)) { /* v2.1.20 */
+      return 0;
+   }
+
    if (buffer)
       len = buffer_len;
    else
@@ -3320,6 +4415,177 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
+/* v2.1.20 Write an integer subscript directly to the input buffer.  type is DBX_DTYPE_INT or DBX_DTYPE_INT64 and is
+   retained so that the InterSystems API can push the value natively.
+*/
+int dbx_ibuffer_add_int(DBXMETH *pmeth, int argn, long long num, short type)
+{
+   int len;
+   char buffer[32];
+   unsigned char *p, *phead;
+   v8::Local<v8::String> str;
+   DBXCON *pcon = pmeth->pcon;
+
+   if (!DBX_ARGS_RESERVE(pmeth, argn)) {
+      return 0;
+   }
+
+   if ((pmeth->ibuffer_used + 64) > pmeth->ibuffer_size) {
+      len = dbx_int64_to_str(buffer, num);
+      pmeth->args[argn].type = (type == DBX_DTYPE_INT) ? DBX_DTYPE_INT : DBX_DTYPE_STR;
+      len = dbx_ibuffer_add(pmeth, NULL, argn, str, buffer, len, 0);
+   }
+   else {
+      phead = (pmeth->ibuffer + pmeth->ibuffer_used);
+      p = phead + 5;
+      len = dbx_int64_to_str((char *) p, num);
+      pmeth->ibuffer_used += (5 + len);
+
+      if (pcon->net_connection) {
+         dbx_add_block_size(phead, 0, len, pmeth->args[argn].sort, (type == DBX_DTYPE_INT) ? DBX_DTYPE_INT : DBX_DTYPE_STR);
+      }
+
+      pmeth->args[argn].svalue.buf_addr = (char *) p;
+      pmeth->args[argn].svalue.len_alloc = len;
+      pmeth->args[argn].svalue.len_used = len;
+
+      if (pcon->dbtype == DBX_DBTYPE_YOTTADB && argn > 0) {
+         pmeth->yargs[argn - 1].len_used = len;
+         pmeth->yargs[argn - 1].len_alloc = len;
+         pmeth->yargs[argn - 1].buf_addr = (char *) p;
+      }
+   }
+
+   pmeth->args[argn].type = type;
+   if (type == DBX_DTYPE_INT) {
+      pmeth->args[argn].num.int32 = (int) num;
+   }
+   else {
+      pmeth->args[argn].num.int64 = num;
+   }
+
+   return len;
+}
+
+
+/* v2.1.20 Add a Buffer argument: over a network connection a large one is not copied but sent from the Buffer itself by netx_tcp_writev() */
+int dbx_ibuffer_add_buffer(DBXMETH *pmeth, v8::Isolate * isolate, int argn, v8::Local<v8::Object> obj, short context)
+{
+   int type;
+   unsigned int len;
+   unsigned char *phead;
+   v8::Local<v8::String> str;
+   DBXIOV *piov;
+   DBXCON *pcon = pmeth->pcon;
+
+   len = (unsigned int) node::Buffer::Length(obj);
+
+   if (!pcon->net_connection || len < DBX_IOV_MIN_SIZE || pmeth->iov_n >= DBX_IOV_MAX || (pmeth->ibuffer_used + 32) > pmeth->ibuffer_size || !DBX_ARGS_RESERVE(pmeth, argn)) {
+      return dbx_ibuffer_add(pmeth, isolate, argn, str, node::Buffer::Data(obj), (int) len, context);
+   }
+
+   /* only the block header goes into the input buffer */
+   phead = (pmeth->ibuffer + pmeth->ibuffer_used);
+   pmeth->ibuffer_used += 5;
+   type = pmeth->args[argn].type;
+   pmeth->args[argn].type = DBX_DTYPE_STR;
+   dbx_add_block_size(phead, 0, len, pmeth->args[argn].sort, type);
+
+   piov = &(pmeth->iov[pmeth->iov_n]);
+   piov->offset = pmeth->ibuffer_used;
+   piov->len = len;
+   piov->data = node::Buffer::Data(obj);
+   piov->pref = (void *) new v8::Persistent<v8::Object>(isolate, obj); /* asynchronous requests are sent after the caller has returned */
+   pmeth->iov_n ++;
+   pmeth->iov_len += len;
+
+   pmeth->args[argn].svalue.buf_addr = piov->data;
+   pmeth->args[argn].svalue.len_alloc = len;
+   pmeth->args[argn].svalue.len_used = len;
+
+   return (int) len;
+}
+
+
+/* v2.1.20 Called on the main thread once the request has been sent and answered */
+int dbx_ibuffer_release(DBXMETH *pmeth)
+{
+   int n;
+   v8::Persistent<v8::Object> *pref;
+
+   for (n = 0; n < pmeth->iov_n; n ++) {
+      pref = (v8::Persistent<v8::Object> *) pmeth->iov[n].pref;
+      if (pref) {
+         pref->Reset();
+         delete pref;
+      }
+      pmeth->iov[n].pref = NULL;
+   }
+   pmeth->iov_n = 0;
+   pmeth->iov_len = 0;
+
+   return CACHE_SUCCESS;
+}
+
+
+static const char dbx_digit_pairs[] =
+   "00010203040506070809"
+   "10111213141516171819"
+   "20212223242526272829"
+   "30313233343536373839"
+   "40414243444546474849"
+   "50515253545556575859"
+   "60616263646566676869"
+   "70717273747576777879"
+   "80818283848586878889"
+   "90919293949596979899";
+
+/* v2.1.20 Format an integer two digits at a time; returns the length (the output is null terminated) */
+int dbx_int64_to_str(char *buffer, long long num)
+{
+   int n, len;
+   unsigned long long u;
+   char tmp[24], *p;
+
+   u = (num < 0) ? (0ULL - (unsigned long long) num) : (unsigned long long) num;
+   p = tmp + sizeof(tmp);
+   while (u >= 100) {
+      n = (int) (u % 100) * 2;
+      u /= 100;
+      *(-- p) = dbx_digit_pairs[n + 1];
+      *(-- p) = dbx_digit_pairs[n];
+   }
+   if (u >= 10) {
+      n = (int) u * 2;
+      *(-- p) = dbx_digit_pairs[n + 1];
+      *(-- p) = dbx_digit_pairs[n];
+   }
+   else {
+      *(-- p) = (char) ('0' + u);
+   }
+   if (num < 0) {
+      *(-- p) = '-';
+   }
+
+   len = (int) ((tmp + sizeof(tmp)) - p);
+   memcpy((void *) buffer, (void *) p, (size_t) len);
+   buffer[len] = '\0';
+
+   return len;
+}
+
+
+/* v2.1.20 Returns 1 if a JavaScript number is an integer that formats identically to its string form */
+int dbx_is_integer(double num, long long *pint64)
+{
+   if (num > -9007199254740992.0 && num < 9007199254740992.0 && num == (double) ((long long) num)) {
+      *pint64 = (long long) num;
+      return 1;
+   }
+   return 0;
+}
+
+
 int dbx_global_reset(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Isolate * isolate, DBXCON *pcon, DBXMETH *pmeth, void *pgx, int argc_offset, short context)
 {
    v8::Local<v8::Context> icontext = isolate->GetCurrentContext();
@@ -3343,9 +4609,14 @@ __try {
    while (pval) {
       pvalp = pval;
       pval = pval->pnext;
-      dbx_free((void *) pvalp, 0);
+      dbx_free((void *) pvalp, 401);
    }
    gx->pkey = NULL;
+   gx->key_count = 0;
+   if (gx->pprefix) { /* v2.1.20 */
+      dbx_free((void *) gx->pprefix, 401);
+      gx->pprefix = NULL;
+   }
 
    if (pcon->dbtype == DBX_DBTYPE_YOTTADB) {
       if (global_name[0] == '^') {
@@ -3368,7 +4639,7 @@ __try {
    pvalp = NULL;
    for (n = (argc_offset + 1); n < pmeth->argc; n ++) {
       if (args[n]->IsInt32()) {
-         pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL), 0);
+         pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL), 401);
          pval->type = DBX_DTYPE_INT;
          pval->num.int32 = (int) DBX_INT32_VALUE(args[n]);
       }
@@ -3377,7 +4648,7 @@ __try {
          if (otype == 2) {
             p = node::Buffer::Data(obj);
             len = (int) node::Buffer::Length(obj);
-            pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL) + len + 32, 0);
+            pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL) + len + 32, 401);
             pval->type = DBX_DTYPE_STR;
             pval->svalue.buf_addr = ((char *) pval) + sizeof(DBXVAL);
             memcpy((void *) pval->svalue.buf_addr, (void *) p, (size_t) len);
@@ -3387,7 +4658,7 @@ __try {
          else {
             str = DBX_TO_STRING(args[n]);
             len = (int) dbx_string8_length(isolate, str, 0);
-            pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL) + len + 32, 0);
+            pval = (DBXVAL *) dbx_malloc(sizeof(DBXVAL) + len + 32, 401);
             pval->type = DBX_DTYPE_STR;
             pval->svalue.buf_addr = ((char *) pval) + sizeof(DBXVAL);
             dbx_write_char8(isolate, str, pval->svalue.buf_addr, 1);
@@ -3403,8 +4674,11 @@ __try {
       }
       pvalp = pval;
       pvalp->pnext = NULL;
+      gx->key_count ++;
    }
 
+   gx->pprefix = dbx_global_prefix(pmeth, gx->global_name, gx->pkey); /* v2.1.20 */
+
    return 0;
 
 #ifdef _WIN32
@@ -3429,6 +4703,87 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
+/* v2.1.20 Encode the global name and fixed subscripts once, exactly as GlobalReference() would write them to the input buffer */
+DBXGPFX * dbx_global_prefix(DBXMETH *pmeth, char *global, DBXVAL *pkey)
+{
+   int nx;
+   unsigned int offset;
+   DBXVAL *pval;
+   DBXGPFX *pprefix;
+   v8::Local<v8::String> str;
+
+   pmeth->ibuffer_used = 0;
+   nx = 0;
+   pmeth->args[nx].cvalue.pstr = 0;
+   if (!dbx_ibuffer_add(pmeth, NULL, nx, str, global, (int) strlen(global), 0)) {
+      return NULL;
+   }
+   nx ++;
+   for (pval = pkey; pval; pval = pval->pnext, nx ++) {
+      if (!DBX_ARGS_RESERVE(pmeth, nx)) {
+         pmeth->ibuffer_used = 0;
+         return NULL;
+      }
+      pmeth->args[nx].cvalue.pstr = 0;
+      if (pval->type == DBX_DTYPE_INT) {
+         dbx_ibuffer_add_int(pmeth, nx, (long long) pval->num.int32, DBX_DTYPE_INT);
+      }
+      else {
+         dbx_ibuffer_add(pmeth, NULL, nx, str, pval->svalue.buf_addr, (int) pval->svalue.len_used, 0);
+      }
+   }
+
+   offset = sizeof(DBXGPFX) + (nx * sizeof(DBXGPFXARG));
+   pprefix = (DBXGPFX *) dbx_malloc(offset + pmeth->ibuffer_used, 401);
+   if (pprefix) {
+      pprefix->argc = nx;
+      pprefix->ibuffer_used = pmeth->ibuffer_used;
+      pprefix->ibuffer = ((unsigned char *) pprefix) + offset;
+      memcpy((void *) pprefix->ibuffer, (void *) pmeth->ibuffer, (size_t) pmeth->ibuffer_used);
+      for (nx = 0; nx < pprefix->argc; nx ++) {
+         pprefix->args[nx].type = pmeth->args[nx].type;
+         pprefix->args[nx].int32 = pmeth->args[nx].num.int32;
+         pprefix->args[nx].offset = (unsigned int) ((unsigned char *) pmeth->args[nx].svalue.buf_addr - pmeth->ibuffer);
+         pprefix->args[nx].len = pmeth->args[nx].svalue.len_used;
+      }
+   }
+   pmeth->ibuffer_used = 0;
+
+   return pprefix;
+}
+
+
+/* v2.1.20 Copy a pre-encoded prefix to the start of the input buffer; returns the number of arguments it supplies or zero if it can't be used */
+int dbx_global_prefix_add(DBXMETH *pmeth, DBXGPFX *pprefix)
+{
+   int n;
+   DBXCON *pcon = pmeth->pcon;
+
+   if ((pprefix->ibuffer_used + 32) > pmeth->ibuffer_size || !DBX_ARGS_RESERVE(pmeth, pprefix->argc - 1)) {
+      return 0;
+   }
+
+   memcpy((void *) pmeth->ibuffer, (void *) pprefix->ibuffer, (size_t) pprefix->ibuffer_used);
+   pmeth->ibuffer_used = pprefix->ibuffer_used;
+
+   for (n = 0; n < pprefix->argc; n ++) {
+      pmeth->args[n].cvalue.pstr = 0;
+      pmeth->args[n].type = pprefix->args[n].type;
+      pmeth->args[n].num.int32 = pprefix->args[n].int32;
+      pmeth->args[n].svalue.buf_addr = (char *) (pmeth->ibuffer + pprefix->args[n].offset);
+      pmeth->args[n].svalue.len_alloc = pprefix->args[n].len;
+      pmeth->args[n].svalue.len_used = pprefix->args[n].len;
+      if (pcon->dbtype == DBX_DBTYPE_YOTTADB && n > 0) {
+         pmeth->yargs[n - 1].buf_addr = pmeth->args[n].svalue.buf_addr;
+         pmeth->yargs[n - 1].len_alloc = pprefix->args[n].len;
+         pmeth->yargs[n - 1].len_used = pprefix->args[n].len;
+      }
+   }
+
+   return pprefix->argc;
+}
+
+
 int dbx_cursor_init(void *pcx)
 {
    mcursor *cx = (mcursor *) pcx;
@@ -3447,6 +4802,19 @@ int dbx_cursor_init(void *pcx)
    cx->psql = NULL;
    cx->c = NULL;
 
+   /* v2.1.20 */
+   cx->fetching = 0;
+   cx->fetch_buf = 0;
+   cx->ahead_eod = 0;
+   cx->ahead_cur = 0;
+   cx->close_pending = 0;
+   cx->wait_queued = 0;
+   cx->batch_size = 0;
+   cx->wait_max = 0;
+   cx->pwait = NULL;
+   memset((void *) cx->ahead, 0, sizeof(cx->ahead));
+   cx->ahead_error[0] = '\0';
+
    return 0;
 }
 
@@ -3475,7 +4843,7 @@ __try {
    if (DBX_GET(obj, key)->IsString()) {
       value = DBX_TO_STRING(DBX_GET(obj, key));
       len = (int) dbx_string8_length(isolate, value, 0);
-      psql = (DBXSQL *) dbx_malloc(sizeof(DBXSQL) + (len + 4), 0);
+      psql = (DBXSQL *) dbx_malloc(sizeof(DBXSQL) + (len + 4), 701);
       for (n = 0; n < DBX_SQL_MAXCOL; n ++) {
          psql->cols[n] = NULL;
       }
@@ -3531,10 +4899,8 @@ __try {
    if (!cx->pqr_next) {
       cx->pqr_next = dbx_alloc_dbxqr(NULL, 0, 0);
    }
-   if (!cx->data.buf_addr) {
-      cx->data.buf_addr = (char *) dbx_malloc(CACHE_MAXSTRLEN, 0);
-      cx->data.len_alloc = CACHE_MAXSTRLEN;
-      cx->data.len_used = 0;
+   if (!cx->pqr_prev || !cx->pqr_next) {
+      return -1;
    }
 
    key = dbx_new_string8(isolate, (char *) "global", 1);
@@ -3599,10 +4965,15 @@ __try {
       Local<Array> a = Local<Array>::Cast(DBX_GET(obj, key));
       cx->pqr_prev->keyn = (int) a->Length();
       for (n = 0; n < cx->pqr_prev->keyn; n ++) {
+         char *p;
          value = DBX_TO_STRING(DBX_GET(a, n));
-         len = (int) dbx_string8_length(isolate, value, 0);
-         dbx_write_char8(isolate, value, cx->pqr_prev->key[n].buf_addr, 1);
-         cx->pqr_prev->key[n].len_used = len;
+         len = (int) dbx_string8_length(isolate, value, pcon->utf8);
+         p = dbx_qr_key_alloc(cx->pqr_prev, n, (unsigned int) len); /* v2.1.20 */
+         if (!p) {
+            cx->pqr_prev->keyn = n;
+            break;
+         }
+         dbx_write_char8(isolate, value, p, pcon->utf8);
       }
    }
 
@@ -4411,7 +5782,7 @@ __try {
    error_code = 0;
 
    if (!pcon->p_isc_so) {
-      pcon->p_isc_so = (DBXISCSO *) dbx_malloc(sizeof(DBXISCSO), 0);
+      pcon->p_isc_so = (DBXISCSO *) dbx_malloc(sizeof(DBXISCSO), 901);
       if (!pcon->p_isc_so) {
          T_STRCPY(pcon->error, _dbxso(pcon->error), "No Memory");
          pcon->error_code = 1009; 
@@ -4654,13 +6025,14 @@ int isc_cleanup(DBXMETH *pmeth)
 __try {
 #endif
 
-   for (n = 0; n < DBX_MAXARGS; n ++) {
+   for (n = 0; n < pmeth->args_exstr; n ++) { /* v2.1.20 */
       if (pmeth->args[n].cvalue.pstr) {
          /* printf("\r\ncache_cleanup %d &zstr=%p; pstr=%p;", n, &(pcon->cargs[n].zstr), pcon->cargs[n].pstr); */
          pcon->p_isc_so->p_CacheExStrKill(&(pmeth->args[n].cvalue.zstr));
          pmeth->args[n].cvalue.pstr = NULL;
       }
    }
+   pmeth->args_exstr = 0;
    return 1;
 
 #ifdef _WIN32
@@ -5379,7 +6751,7 @@ int ydb_open(DBXMETH *pmeth)
    DBXCON *pcon = pmeth->pcon;
 
    if (!pcon->p_ydb_so) {
-      pcon->p_ydb_so = (DBXYDBSO *) dbx_malloc(sizeof(DBXYDBSO), 0);
+      pcon->p_ydb_so = (DBXYDBSO *) dbx_malloc(sizeof(DBXYDBSO), 901);
       if (!pcon->p_ydb_so) {
          T_STRCPY(pcon->error, _dbxso(pcon->error), "No Memory");
          pcon->error_code = 1009; 
@@ -5737,6 +7109,18 @@ __try {
 
    if (pcon->tcp_port && pcon->net_host[0]) {
 
+#if !defined(_WIN32)
+      if (pcon->shared) { /* v2.1.20 */
+         rc = dbx_broker_attach(pcon);
+         goto dbx_open_exit;
+      }
+#endif
+
+      /* v2.1.20 only the in-process APIs share mutex_global */
+      pcon->mutex_net.created = 0;
+      dbx_mutex_create(&(pcon->mutex_net));
+      pcon->p_mutex = &(pcon->mutex_net);
+
       rc = netx_tcp_connect(pcon, 0);
 
       if (rc != CACHE_SUCCESS) {
@@ -5754,7 +7138,19 @@ __try {
          goto dbx_open_exit;
       }
 
-      dbx_pool_thread_init(pcon, 1);
+#if !defined(_WIN32)
+      /* v2.1.20 with revision 2 of the protocol, the requests of every thread are pipelined over this connection */
+      if (pcon->net_revision == 2 && netx_pipe_open(pcon) != CACHE_SUCCESS) {
+         netx_tcp_disconnect(pcon, 0);
+         rc = CACHE_NOCON;
+         goto dbx_open_exit;
+      }
+
+      /* v2.1.20 each worker of a pool of more than one thread has its own connection to the server (or its own share of a pipelined connection) */
+      if (pcon->transport != DBX_TRANSPORT_UV) { /* the event-loop transport is started by the primary thread, see dbx_uv_open() */
+         pcon->ppool = (void *) dbx_pool_create(pcon, pcon->pool_size, (short) (pcon->pool_size > 1));
+      }
+#endif
 
       pcon->net_connection = 1; /* network connection */
 
@@ -5775,6 +7171,12 @@ __try {
       pcon->p_isc_so->no_connections ++;
       pcon->p_isc_so->multiple_connections ++;
       pcon->p_zv = &(p_isc_so_global->zv);
+#if !defined(_WIN32)
+      if (!pcon->p_isc_so->ppool) { /* v2.1.20 */
+         pcon->p_isc_so->ppool = (void *) dbx_pool_create(pcon, 1, 0);
+      }
+      pcon->ppool = pcon->p_isc_so->ppool;
+#endif
       dbx_leave_critical_section((void *) &dbx_async_mutex);
       return rc;
    }
@@ -5785,6 +7187,12 @@ __try {
       pcon->p_ydb_so->no_connections ++;
       pcon->p_ydb_so->multiple_connections ++;
       pcon->p_zv = &(p_ydb_so_global->zv);
+#if !defined(_WIN32)
+      if (!pcon->p_ydb_so->ppool) { /* v2.1.20 */
+         pcon->p_ydb_so->ppool = (void *) dbx_pool_create(pcon, 1, 0);
+      }
+      pcon->ppool = pcon->p_ydb_so->ppool;
+#endif
       dbx_leave_critical_section((void *) &dbx_async_mutex);
       return rc;
    }
@@ -5800,7 +7208,19 @@ __try {
       p_ydb_so_global = pcon->p_ydb_so;
    }
 
-   dbx_pool_thread_init(pcon, 1);
+#if !defined(_WIN32)
+   /* v2.1.20 one database thread per API: the call-in interfaces are not used concurrently */
+   if (rc == CACHE_SUCCESS) {
+      if (pcon->p_ydb_so) {
+         pcon->p_ydb_so->ppool = (void *) dbx_pool_create(pcon, 1, 0);
+         pcon->ppool = pcon->p_ydb_so->ppool;
+      }
+      else if (pcon->p_isc_so) {
+         pcon->p_isc_so->ppool = (void *) dbx_pool_create(pcon, 1, 0);
+         pcon->ppool = pcon->p_isc_so->ppool;
+      }
+   }
+#endif
 
    dbx_leave_critical_section((void *) &dbx_async_mutex);
 
@@ -5842,6 +7262,7 @@ int dbx_do_nothing(DBXMETH *pmeth)
 int dbx_close(DBXMETH *pmeth)
 {
    int no_connections;
+   void *ppool;
    DBXCON *pcon = pmeth->pcon;
 
 #ifdef _WIN32
@@ -5850,27 +7271,60 @@ __try {
 
    no_connections = 0;
 
+   /* v2.1.20 a network connection's pool is its own: an API's pool goes with its last connection */
+   ppool = pcon->ppool;
+   pcon->ppool = NULL;
+
+#if !defined(_WIN32)
+   if (pcon->pbroker) { /* v2.1.20 the pool belongs to the broker */
+      ppool = NULL;
+      dbx_broker_detach(pcon);
+   }
+   netx_uv_close(pcon); /* v2.1.20 */
+#endif
+
    dbx_enter_critical_section((void *) &dbx_async_mutex);
    if (pcon->dbtype == DBX_DBTYPE_YOTTADB) {
       if (pcon->p_ydb_so) {
          pcon->p_ydb_so->no_connections --;
          no_connections =  pcon->p_ydb_so->no_connections;
+         if (no_connections == 0) {
+            pcon->p_ydb_so->ppool = NULL;
+         }
+         else {
+            ppool = NULL;
+         }
       }
    }
    else {
       if (pcon->p_isc_so) {
          pcon->p_isc_so->no_connections --;
          no_connections =  pcon->p_isc_so->no_connections;
+         if (no_connections == 0) {
+            pcon->p_isc_so->ppool = NULL;
+         }
+         else {
+            ppool = NULL;
+         }
       }
    }
    dbx_leave_critical_section((void *) &dbx_async_mutex);
 
+#if !defined(_WIN32)
+   dbx_pool_shutdown((DBXPOOL *) ppool);
+   netx_pipe_close(pcon); /* v2.1.20 */
+#endif
+
    /* printf("\r\ndbx_close: no_connections=%d\r\n", no_connections); */
 
-   if (pcon->net_connection) {
+   if (pcon->net_connection || pcon->rbuf) { /* v2.1.20 a connection lost by the server still has its socket and buffer */
       netx_tcp_disconnect(pcon, 0);
       pcon->net_connection = 0;
    }
+   if (pcon->p_mutex == &(pcon->mutex_net)) { /* v2.1.20 */
+      pcon->p_mutex = &mutex_global;
+      dbx_mutex_destroy(&(pcon->mutex_net));
+   }
    else if (pcon->dbtype == DBX_DBTYPE_YOTTADB) {
 
       /* printf("\r\ndbx_close: no_connections=%d; pcon->p_ydb_so->multiple_connections=%d;\r\n", no_connections, pcon->p_ydb_so->multiple_connections); */
@@ -6044,6 +7498,9 @@ __try {
    if (pmeth->args[n].type == DBX_DTYPE_INT) {
       rc = pcon->p_isc_so->p_CachePushInt((int) pmeth->args[n].num.int32);
    }
+   else if (pmeth->args[n].type == DBX_DTYPE_INT64 && pcon->p_isc_so->p_CachePushInt64) { /* v2.1.20 */
+      rc = pcon->p_isc_so->p_CachePushInt64((CACHE_INT64) pmeth->args[n].num.int64);
+   }
    else if (pmeth->args[n].type == DBX_DTYPE_DOUBLE) {
       rc = pcon->p_isc_so->p_CachePushDbl(pmeth->args[n].num.real);
       /* rc = pcon->p_isc_so->p_CachePushIEEEDbl(pmeth->args[n].num.real); */
@@ -6057,6 +7514,9 @@ __try {
       }
       else {
          pmeth->args[n].cvalue.pstr = (void *) pcon->p_isc_so->p_CacheExStrNew((CACHE_EXSTRP) &(pmeth->args[n].cvalue.zstr), pmeth->args[n].svalue.len_used + 1);
+         if (n >= pmeth->args_exstr) { /* v2.1.20 */
+            pmeth->args_exstr = n + 1;
+         }
          for (ne = 0; ne < pmeth->args[n].svalue.len_used; ne ++) {
             pmeth->args[n].cvalue.zstr.str.ch[ne] = (char) pmeth->args[n].svalue.buf_addr[ne];
          }
@@ -6888,6 +8348,9 @@ __try {
          }
          else {
             pmeth->args[0].cvalue.pstr = (void *) pcon->p_isc_so->p_CacheExStrNew((CACHE_EXSTRP) &(pmeth->args[0].cvalue.zstr), netbuf_used + 1);
+            if (pmeth->args_exstr < 1) { /* v2.1.20 */
+               pmeth->args_exstr = 1;
+            }
             for (ne = 0; ne < (int) netbuf_used; ne ++) {
                pmeth->args[0].cvalue.zstr.str.ch[ne] = (char) netbuf[ne];
             }
@@ -7586,7 +9049,7 @@ __try {
          break;
       }
 
-      pmeth->psql->cols[cn] = (DBXSQLCOL *) dbx_malloc(sizeof(DBXSQLCOL) + (len + 4), 0);
+      pmeth->psql->cols[cn] = (DBXSQLCOL *) dbx_malloc(sizeof(DBXSQLCOL) + (len + 4), 701);
       pmeth->psql->cols[cn]->name.buf_addr = ((char *) pmeth->psql->cols[cn]) + sizeof(DBXSQLCOL);
       strncpy(pmeth->psql->cols[cn]->name.buf_addr, pmeth->output_val.svalue.buf_addr + offset, len);
       pmeth->psql->cols[cn]->name.buf_addr[len] = '\0';
@@ -7910,7 +9373,7 @@ __try {
 
    for (n = 0; n < pmeth->psql->no_cols; n ++) {
       if (pmeth->psql->cols[n]) {
-         dbx_free((void *) pmeth->psql->cols[n], 0);
+         dbx_free((void *) pmeth->psql->cols[n], 701);
          pmeth->psql->cols[n] = NULL;
       }
    }
@@ -8177,13 +9640,18 @@ __try {
       if (getdata && pmeth->output_val.svalue.len_used > 0) {
          len = dbx_get_block_size((unsigned char *) pmeth->output_val.svalue.buf_addr, 0, &(pmeth->output_val.sort), &(pmeth->output_val.type));
          nx = 5;
-         strncpy(pqr_prev->key[pqr_prev->keyn - 1].buf_addr, pmeth->output_val.svalue.buf_addr + nx, len);
-         pqr_prev->key[pqr_prev->keyn - 1].len_used = len;
+         dbx_qr_key_set(pqr_prev, pqr_prev->keyn - 1, pmeth->output_val.svalue.buf_addr + nx, len); /* v2.1.20 */
          nx += len;
          len = dbx_get_block_size((unsigned char *) pmeth->output_val.svalue.buf_addr + nx, 0, &(pmeth->output_val.sort), &(pmeth->output_val.type));
          nx += 5;
-         strncpy(pqr_prev->data.svalue.buf_addr, pmeth->output_val.svalue.buf_addr + nx, len);
-         pqr_prev->data.svalue.len_used = len;
+         if (dbx_qr_data_reserve(pqr_prev, len + 1) == CACHE_SUCCESS) { /* v2.1.20 */
+            memcpy((void *) pqr_prev->data.svalue.buf_addr, (void *) (pmeth->output_val.svalue.buf_addr + nx), (size_t) len);
+            pqr_prev->data.svalue.buf_addr[len] = '\0';
+            pqr_prev->data.svalue.len_used = len;
+         }
+      }
+      else if (!getdata && rc == CACHE_SUCCESS) {
+         dbx_qr_key_set(pqr_prev, pqr_prev->keyn - 1, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used); /* v2.1.20 */
       }
    }
    else if (pcon->dbtype == DBX_DBTYPE_YOTTADB) {
@@ -8196,13 +9664,15 @@ __try {
       }
 
       if (getdata && pmeth->output_val.svalue.len_used > 0) {
-         strcpy(pqr_prev->key[pqr_prev->keyn - 1].buf_addr, pmeth->output_val.svalue.buf_addr);
-         pqr_prev->key[pqr_prev->keyn - 1].len_used =  pmeth->output_val.svalue.len_used;
+         dbx_qr_key_set(pqr_prev, pqr_prev->keyn - 1, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used); /* v2.1.20 */
+         dbx_qr_data_reserve(pqr_prev, DBX_QR_DATA_MIN);
          rc = pcon->p_ydb_so->p_ydb_get_s(&(pqr_prev->global_name), pqr_prev->keyn, &pqr_prev->key[0], &(pqr_prev->data.svalue));
+         if (rc == YDB_ERR_INVSTRLEN && dbx_qr_data_reserve(pqr_prev, pqr_prev->data.svalue.len_used + 1) == CACHE_SUCCESS) {
+            rc = pcon->p_ydb_so->p_ydb_get_s(&(pqr_prev->global_name), pqr_prev->keyn, &pqr_prev->key[0], &(pqr_prev->data.svalue));
+         }
       }
       if (rc == CACHE_SUCCESS) {
-         strcpy(pqr_prev->key[pqr_prev->keyn - 1].buf_addr, pmeth->output_val.svalue.buf_addr);
-         pqr_prev->key[pqr_prev->keyn - 1].len_used =  pmeth->output_val.svalue.len_used;
+         dbx_qr_key_set(pqr_prev, pqr_prev->keyn - 1, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used); /* v2.1.20 */
       }
    }
    else {
@@ -8215,7 +9685,6 @@ __try {
         if (getdata) {
             rc = isc_pop_value(pmeth, &(pmeth->output_val), DBX_DTYPE_STR);
             if (pmeth->output_val.svalue.len_used == 1 && pmeth->output_val.svalue.buf_addr[0] == '0') {
-               pqr_prev->data.svalue.buf_addr[0] = '\0';
                pqr_prev->data.svalue.len_used = 0;
                rc = isc_pop_value(pmeth, &(pmeth->output_val), DBX_DTYPE_STR);
             }
@@ -8229,8 +9698,7 @@ __try {
          }
       }
       if (rc == CACHE_SUCCESS) {
-         strcpy(pqr_prev->key[pqr_prev->keyn - 1].buf_addr, pmeth->output_val.svalue.buf_addr);
-         pqr_prev->key[pqr_prev->keyn - 1].len_used =  pmeth->output_val.svalue.len_used;
+         dbx_qr_key_set(pqr_prev, pqr_prev->keyn - 1, pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_used); /* v2.1.20 */
       }
    }
 
@@ -8310,7 +9778,6 @@ __try {
          dbx_parse_global_reference(pmeth, pqr_next, (char *) (pmeth->output_val.svalue.buf_addr + nx), (int) len);
          if (len == 0) {
             eod = 1;
-            pqr_next->data.svalue.buf_addr[0] = '\0';
             pqr_next->data.svalue.len_used = 0;
             pqr_next->keyn = 0;
          }
@@ -8318,8 +9785,12 @@ __try {
             nx += len;
             len = dbx_get_block_size((unsigned char *) pmeth->output_val.svalue.buf_addr + nx, 0, &(pmeth->output_val.sort), &(pmeth->output_val.type));
             nx += 5;
-            pqr_next->data.svalue.buf_addr = pmeth->output_val.svalue.buf_addr + nx;
-            pqr_next->data.svalue.len_used = len;
+            /* v2.1.20 copy the data: the response buffer is reused (and may be released) by the next request */
+            if (dbx_qr_data_reserve(pqr_next, len + 1) == CACHE_SUCCESS) {
+               memcpy((void *) pqr_next->data.svalue.buf_addr, (void *) (pmeth->output_val.svalue.buf_addr + nx), (size_t) len);
+               pqr_next->data.svalue.buf_addr[len] = '\0';
+               pqr_next->data.svalue.len_used = len;
+            }
          }
       }
       else {
@@ -8330,24 +9801,56 @@ __try {
       }
    }
    else if (pcon->dbtype == DBX_DBTYPE_YOTTADB) {
-      pqr_next->keyn = DBX_MAXARGS;
+      unsigned int slot, size;
 
-      if (dir == 1) {
-         rc = pcon->p_ydb_so->p_ydb_node_next_s(&(pqr_prev->global_name), pqr_prev->keyn, &pqr_prev->key[0], &(pqr_next->keyn), &pqr_next->key[0]);
+      /* v2.1.20 carve equal output slots from the key arena; widen them and retry if a subscript does not fit */
+      slot = pqr_next->kbuffer_size / DBX_MAXARGS;
+      if (slot < DBX_QR_KEY_SLOT) {
+         slot = DBX_QR_KEY_SLOT;
       }
-      else {
-         rc = pcon->p_ydb_so->p_ydb_node_previous_s(&(pqr_prev->global_name), pqr_prev->keyn, &pqr_prev->key[0], &(pqr_next->keyn), &pqr_next->key[0]);
+      for (;;) {
+         pqr_next->kbuffer_used = 0;
+         if (dbx_qr_reserve(pqr_next, slot * DBX_MAXARGS) != CACHE_SUCCESS) {
+            rc = YDB_NOTOK;
+            pqr_next->keyn = 0;
+            break;
+         }
+         for (n = 0; n < DBX_MAXARGS; n ++) {
+            pqr_next->key[n].buf_addr = (char *) pqr_next->kbuffer + (n * slot);
+            pqr_next->key[n].len_alloc = slot;
+            pqr_next->key[n].len_used = 0;
+         }
+         pqr_next->kbuffer_used = slot * DBX_MAXARGS;
+         pqr_next->keyn = DBX_MAXARGS;
+
+         if (dir == 1) {
+            rc = pcon->p_ydb_so->p_ydb_node_next_s(&(pqr_prev->global_name), pqr_prev->keyn, &pqr_prev->key[0], &(pqr_next->keyn), &pqr_next->key[0]);
+         }
+         else {
+            rc = pcon->p_ydb_so->p_ydb_node_previous_s(&(pqr_prev->global_name), pqr_prev->keyn, &pqr_prev->key[0], &(pqr_next->keyn), &pqr_next->key[0]);
+         }
+         if (rc != YDB_ERR_INVSTRLEN || slot >= DBX_QR_KEY_SLOT_MAX) {
+            break;
+         }
+         size = slot * 2;
+         if (pqr_next->keyn >= 0 && pqr_next->keyn < DBX_MAXARGS && pqr_next->key[pqr_next->keyn].len_used >= size) {
+            size = pqr_next->key[pqr_next->keyn].len_used + 1;
+         }
+         slot = size;
       }
 
       /* printf("\r\npqr_next->keyn=%d; rc=%d\r\n", pqr_next->keyn, rc); */
       if (pqr_next->keyn == YDB_NODE_END || rc != YDB_OK) { /* v1.3.8 */
          eod = 1;
-         pqr_next->data.svalue.buf_addr[0] = '\0';
          pqr_next->data.svalue.len_used = 0; /* v1.3.8 */
          pqr_next->keyn = 0;
       }
       if (getdata && !eod) {
+         dbx_qr_data_reserve(pqr_next, DBX_QR_DATA_MIN);
          rc = pcon->p_ydb_so->p_ydb_get_s(&(pqr_next->global_name), pqr_next->keyn, &pqr_next->key[0], &(pqr_next->data.svalue));
+         if (rc == YDB_ERR_INVSTRLEN && dbx_qr_data_reserve(pqr_next, pqr_next->data.svalue.len_used + 1) == CACHE_SUCCESS) {
+            rc = pcon->p_ydb_so->p_ydb_get_s(&(pqr_next->global_name), pqr_next->keyn, &pqr_next->key[0], &(pqr_next->data.svalue));
+         }
       }
    }
    else {
@@ -8411,25 +9914,232 @@ __except (EXCEPTION_EXECUTE_HANDLER) {
 }
 
 
-int dbx_parse_global_reference(DBXMETH *pmeth, DBXQR *pqr, char *global_ref, int global_ref_len)
+/* v2.1.20 DB THREAD : read the next batch of records for an mcursor into its read-ahead buffer */
+int dbx_cursor_fetch(DBXMETH *pmeth)
 {
-   int n, nq;
-   unsigned int len;
-   char *p, *p1, *pc, *pc0;
+   int rc, n, len, dsort, dtype, nfields;
+   unsigned int hdr;
+   short eod;
+   DBXQR *pqr;
+   DBXCON *pcon = pmeth->pcon;
+   mcursor *cx = (mcursor *) pmeth->pcursor;
+   DBXCURBUF *pbuf = &(cx->ahead[cx->fetch_buf]);
 
 #ifdef _WIN32
 __try {
 #endif
 
-   if (global_ref_len == 0) {
-      global_ref_len = (int) strlen(global_ref);
-      if (global_ref_len == 0) {
-         pqr->keyn = 0;
-         return 0;
+   pbuf->eod = 0;
+   pbuf->nrec = 0;
+   pbuf->next_rec = 0;
+   pbuf->offs = 0;
+   pbuf->rec.len_used = 0;
+   pmeth->error[0] = '\0'; /* errors are recorded against the request: the connection may be serving others */
+   eod = 0;
+
+   while (pbuf->nrec < cx->batch_size) {
+
+      /* reserve space for the field count */
+      hdr = pbuf->rec.len_used;
+      if (dbx_cursor_add_field(&(pbuf->rec), NULL, 0) < 0) {
+         goto dbx_cursor_fetch_nomem;
       }
-   }
+      nfields = 0;
 
-   if (global_ref[global_ref_len - 1] == ')') {
+      if (cx->context == 1) {
+         if (cx->pqr_prev->keyn < 1) {
+            eod = 1;
+         }
+         else {
+            DBX_DB_LOCK(n, 0);
+            dbx_global_order(pmeth, cx->pqr_prev, 1, cx->getdata);
+            DBX_DB_UNLOCK(n);
+
+            pqr = cx->pqr_prev;
+            if (pqr->key[pqr->keyn - 1].len_used == 0) {
+               eod = 1;
+            }
+            else {
+               if (dbx_cursor_add_field(&(pbuf->rec), (char *) pqr->key[pqr->keyn - 1].buf_addr, (int) pqr->key[pqr->keyn - 1].len_used) < 0) {
+                  goto dbx_cursor_fetch_nomem;
+               }
+               nfields ++;
+               if (cx->getdata) {
+                  if (dbx_cursor_add_field(&(pbuf->rec), (char *) pqr->data.svalue.buf_addr, (int) pqr->data.svalue.len_used) < 0) {
+                     goto dbx_cursor_fetch_nomem;
+                  }
+                  nfields ++;
+               }
+            }
+         }
+      }
+      else if (cx->context == 2) {
+         DBX_DB_LOCK(n, 0);
+         rc = dbx_global_query(pmeth, cx->pqr_next, cx->pqr_prev, 1, cx->getdata);
+         DBX_DB_UNLOCK(n);
+
+         pqr = cx->pqr_next;
+         if (rc == CACHE_SUCCESS) {
+            for (n = 0; n < pqr->keyn; n ++) {
+               if (dbx_cursor_add_field(&(pbuf->rec), (char *) pqr->key[n].buf_addr, (int) pqr->key[n].len_used) < 0) {
+                  goto dbx_cursor_fetch_nomem;
+               }
+               nfields ++;
+            }
+            if (cx->getdata) {
+               if (dbx_cursor_add_field(&(pbuf->rec), (char *) pqr->data.svalue.buf_addr, (int) pqr->data.svalue.len_used) < 0) {
+                  goto dbx_cursor_fetch_nomem;
+               }
+               nfields ++;
+            }
+         }
+         else {
+            eod = 1;
+         }
+         cx->pqr_next = cx->pqr_prev;
+         cx->pqr_prev = pqr;
+      }
+      else if (cx->context == 9) {
+         DBX_DB_LOCK(n, 0);
+         rc = dbx_global_directory(pmeth, cx->pqr_prev, 1, &(cx->counter));
+         DBX_DB_UNLOCK(n);
+
+         if (rc) {
+            eod = 1;
+         }
+         else {
+            if (dbx_cursor_add_field(&(pbuf->rec), (char *) cx->pqr_prev->global_name.buf_addr, (int) cx->pqr_prev->global_name.len_used) < 0) {
+               goto dbx_cursor_fetch_nomem;
+            }
+            nfields ++;
+         }
+      }
+      else if (cx->context == 11 && cx->psql) {
+         pmeth->psql = cx->psql;
+         rc = dbx_sql_row(pmeth, pmeth->psql->row_no, 1);
+         if (rc) {
+            eod = 1;
+         }
+         else {
+            for (n = 0; n < pmeth->psql->no_cols; n ++) {
+               len = (int) dbx_get_block_size((unsigned char *) pmeth->output_val.svalue.buf_addr, pmeth->output_val.offs, &dsort, &dtype);
+               pmeth->output_val.offs += 5;
+               if (dsort == DBX_DSORT_EOD || dsort == DBX_DSORT_ERROR) {
+                  break;
+               }
+               if (dbx_cursor_add_field(&(pbuf->rec), (char *) pmeth->output_val.svalue.buf_addr + pmeth->output_val.offs, len) < 0) {
+                  goto dbx_cursor_fetch_nomem;
+               }
+               nfields ++;
+               pmeth->output_val.offs += len;
+            }
+         }
+      }
+      else {
+         eod = 1;
+      }
+
+      if (pmeth->error[0]) {
+         eod = 1;
+      }
+      if (eod) {
+         pbuf->rec.len_used = hdr;
+         break;
+      }
+      memcpy((void *) (pbuf->rec.buf_addr + hdr), (void *) &nfields, sizeof(int));
+      pbuf->nrec ++;
+   }
+
+   if (eod || pmeth->error[0]) {
+      pbuf->eod = 1;
+   }
+
+   return CACHE_SUCCESS;
+
+dbx_cursor_fetch_nomem:
+
+   /* drop the incomplete record so that the field counts match the records delivered */
+   T_STRCPY(pmeth->error, _dbxso(pmeth->error), "Unable to allocate memory for the cursor read-ahead buffer");
+   pbuf->rec.len_used = hdr;
+   pbuf->eod = 1;
+
+   return CACHE_SUCCESS;
+
+#ifdef _WIN32
+}
+__except (EXCEPTION_EXECUTE_HANDLER) {
+
+   DWORD code;
+   char bufferx[256];
+
+   __try {
+      code = GetExceptionCode();
+      sprintf_s(bufferx, 255, "Exception caught in f:dbx_cursor_fetch: %x", code);
+      dbx_log_event(pcon, bufferx, "Error Condition", 0);
+   }
+   __except (EXCEPTION_EXECUTE_HANDLER) {
+      ;
+   }
+
+   return 0;
+}
+#endif
+}
+
+
+/* v2.1.20 append a field (length followed by value) to a read-ahead buffer, growing it in power-of-two steps */
+int dbx_cursor_add_field(DBXSTR *prec, char *data, int len)
+{
+   unsigned int size;
+   char *p;
+
+   size = prec->len_used + sizeof(int) + len;
+   if (size > prec->len_alloc) {
+      size = (prec->len_alloc > 4096) ? prec->len_alloc : 4096;
+      while (size < (prec->len_used + sizeof(int) + len)) {
+         size *= 2;
+      }
+      p = (char *) dbx_malloc(size, 501);
+      if (!p) {
+         return -1;
+      }
+      if (prec->buf_addr) {
+         memcpy((void *) p, (void *) prec->buf_addr, prec->len_used);
+         dbx_free((void *) prec->buf_addr, 501);
+      }
+      prec->buf_addr = p;
+      prec->len_alloc = size;
+   }
+
+   memcpy((void *) (prec->buf_addr + prec->len_used), (void *) &len, sizeof(int));
+   prec->len_used += sizeof(int);
+   if (len > 0) {
+      memcpy((void *) (prec->buf_addr + prec->len_used), (void *) data, len);
+      prec->len_used += len;
+   }
+   return 0;
+}
+
+
+int dbx_parse_global_reference(DBXMETH *pmeth, DBXQR *pqr, char *global_ref, int global_ref_len)
+{
+   int n, nq;
+   unsigned int len;
+   char *p, *p1, *pc, *pc0;
+
+#ifdef _WIN32
+__try {
+#endif
+
+   if (global_ref_len == 0) {
+      global_ref_len = (int) strlen(global_ref);
+      if (global_ref_len == 0) {
+         pqr->keyn = 0;
+         return 0;
+      }
+   }
+
+   if (global_ref[global_ref_len - 1] == ')') {
       global_ref_len --;
       global_ref[global_ref_len] = '\0';
    }
@@ -8498,8 +10208,9 @@ __try {
       }
 
       len = (unsigned int) strlen(p);
-      strcpy((char *) pqr->key[pqr->keyn].buf_addr, (char *) p);
-      pqr->key[pqr->keyn].len_used = len;
+      if (dbx_qr_key_set(pqr, pqr->keyn, p, len) != CACHE_SUCCESS) { /* v2.1.20 */
+         break;
+      }
       pqr->keyn ++;
 
       if (pc)
@@ -8622,7 +10333,7 @@ void * dbx_thread_main(void *pargs)
 */
    pmeth = (DBXMETH *) pargs;
 
-   pmeth->p_dbxfun(pmeth);
+   dbx_request_run(pmeth); /* v2.1.20 */
 
 #if defined(_WIN32)
    return 0;
@@ -8632,102 +10343,347 @@ void * dbx_thread_main(void *pargs)
 }
 
 
-struct dbx_pool_task* dbx_pool_add_task(DBXMETH *pmeth)
+/* v2.1.20 run a request on the connection it was made on and keep the error it raises with the request */
+int dbx_request_run(DBXMETH *pmeth)
 {
-   struct dbx_pool_task* enqueue_task;
+   int rc;
+   DBXCON *pcon = pmeth->pcon;
+
+   /* the main thread uses the same connection: its error is only cleared and read while the request holds the connection */
+   DBX_DB_LOCK(rc, 0);
+   pcon->error[0] = '\0';
+   pcon->error_code = 0;
+   pmeth->p_dbxfun(pmeth);
+   if (pcon->error[0]) {
+      dbx_request_error(pmeth);
+   }
+   DBX_DB_UNLOCK(rc);
+
+   return 0;
+}
+
+
+/* v2.1.20 copy the error raised on the request's connection to the request */
+int dbx_request_error(DBXMETH *pmeth)
+{
+   T_STRCPY(pmeth->error, _dbxso(pmeth->error), pmeth->pcon->error);
+   pmeth->error_code = pmeth->pcon->error_code;
+   return 0;
+}
 
-   enqueue_task = (struct dbx_pool_task*) dbx_malloc(sizeof(struct dbx_pool_task), 601);
 
-   if (!enqueue_task) {
-      dbx_request_errors ++;
+struct dbx_pool_task* dbx_pool_add_task(DBXMETH *pmeth, void *pasync, void *req, void *after_work_cb, int wait)
+{
+#if !defined(_WIN32)
+   DBXPOOL *ppool;
+   struct dbx_pool_task* enqueue_task;
+
+   ppool = (DBXPOOL *) pmeth->pcon->ppool; /* v2.1.20 */
+   if (!ppool) {
       return NULL;
    }
 
+   enqueue_task = &(pmeth->task); /* v2.1.20 */
+
    enqueue_task->task_id = 6;
    enqueue_task->pmeth = pmeth;
    enqueue_task->next = NULL;
+   enqueue_task->pasync = pasync; /* v2.1.20 */
+   enqueue_task->req = req;
+   enqueue_task->after_work_cb = after_work_cb;
 
-#if !defined(_WIN32)
    enqueue_task->parent_tid = pthread_self();
+   enqueue_task->enqueue_ns = dbx_clock_ns();
+   enqueue_task->lane = dbx_pool_lane(pmeth); /* v2.1.20 */
 
-   pthread_mutex_lock(&dbx_task_queue_mutex);
+   /* v2.1.20 a full queue: the event loop must not wait so its caller falls back to uv_queue_work(), other submitters wait for a worker to make room */
+   if (dbx_pool_put_task(ppool, enqueue_task) != CACHE_SUCCESS) {
+      if (!wait) {
+         return NULL;
+      }
+      pthread_mutex_lock(&(ppool->mutex));
+      __atomic_add_fetch(&(ppool->room_waiting), 1, __ATOMIC_SEQ_CST);
+      while (dbx_pool_put_task(ppool, enqueue_task) != CACHE_SUCCESS) {
+         if (__atomic_load_n(&(ppool->stop), __ATOMIC_RELAXED)) {
+            __atomic_sub_fetch(&(ppool->room_waiting), 1, __ATOMIC_SEQ_CST);
+            pthread_mutex_unlock(&(ppool->mutex));
+            dbx_request_errors ++;
+            return NULL;
+         }
+         pthread_cond_wait(&(ppool->room), &(ppool->mutex));
+      }
+      __atomic_sub_fetch(&(ppool->room_waiting), 1, __ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&(ppool->mutex));
+   }
 
-   if (dbx_total_tasks == 0) {
-      tasks = enqueue_task;
-      bottom_task = enqueue_task;
+   __atomic_thread_fence(__ATOMIC_SEQ_CST);
+   if (__atomic_load_n(&(ppool->idle), __ATOMIC_RELAXED) > 0) {
+      pthread_mutex_lock(&(ppool->mutex));
+      pthread_cond_signal(&(ppool->cond));
+      pthread_mutex_unlock(&(ppool->mutex));
    }
-   else {
-      bottom_task->next = enqueue_task;
-      bottom_task = enqueue_task;
+   else if (ppool->ptemplate && __atomic_load_n(&(ppool->size), __ATOMIC_RELAXED) < ppool->size_max &&
+            !__atomic_load_n(&(ppool->starting), __ATOMIC_RELAXED) && !__atomic_load_n(&(ppool->grow_failed), __ATOMIC_RELAXED)) {
+      dbx_pool_grow(ppool); /* v2.1.20 every thread is busy: add another */
    }
 
-   dbx_total_tasks ++;
-
-   pthread_mutex_unlock(&dbx_task_queue_mutex);
-   pthread_cond_signal(&dbx_pool_cond);
+   return enqueue_task;
+#else
+   return NULL;
 #endif
+}
 
-   return enqueue_task;
+
+#if !defined(_WIN32)
+/* v2.1.20 the lane for a request: long running functions, class methods, merges, SQL, locks (which may wait) and cursor read-ahead are kept apart from short global operations */
+short dbx_pool_lane(DBXMETH *pmeth)
+{
+   int (* p_dbxfun) (struct tagDBXMETH * pmeth);
+
+   if (pmeth->lane == DBX_LANE_SHORT || pmeth->lane == DBX_LANE_LONG) {
+      return pmeth->lane;
+   }
+
+   p_dbxfun = pmeth->p_dbxfun;
+   if (p_dbxfun == (int (*) (struct tagDBXMETH * pmeth)) dbx_function || p_dbxfun == (int (*) (struct tagDBXMETH * pmeth)) dbx_classmethod ||
+       p_dbxfun == (int (*) (struct tagDBXMETH * pmeth)) dbx_method || p_dbxfun == (int (*) (struct tagDBXMETH * pmeth)) dbx_merge ||
+       p_dbxfun == (int (*) (struct tagDBXMETH * pmeth)) dbx_sql_execute || p_dbxfun == (int (*) (struct tagDBXMETH * pmeth)) dbx_lock ||
+       p_dbxfun == (int (*) (struct tagDBXMETH * pmeth)) dbx_cursor_fetch) {
+      return DBX_LANE_LONG;
+   }
+   return DBX_LANE_SHORT;
+}
+
+
+/* v2.1.20 Bounded multi-producer/multi-consumer queue: each cell's sequence number tells producers and consumers whose turn it is */
+int dbx_pool_put_task(DBXPOOL *ppool, struct dbx_pool_task *task)
+{
+   long dif;
+   unsigned long pos, seq, depth, dequeue_pos;
+   DBXPOOLCELL *cell;
+   DBXPOOLLANE *plane = &(ppool->lane[task->lane]);
+
+   pos = __atomic_load_n(&(plane->enqueue_pos), __ATOMIC_RELAXED);
+   while (1) {
+      cell = &(plane->queue[pos & plane->queue_mask]);
+      seq = __atomic_load_n(&(cell->sequence), __ATOMIC_ACQUIRE);
+      dif = (long) seq - (long) pos;
+      if (dif == 0) {
+         if (__atomic_compare_exchange_n(&(plane->enqueue_pos), &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+         }
+      }
+      else if (dif < 0) {
+         return CACHE_FAILURE; /* full */
+      }
+      else {
+         pos = __atomic_load_n(&(plane->enqueue_pos), __ATOMIC_RELAXED);
+      }
+   }
+   cell->task = task;
+   __atomic_store_n(&(cell->sequence), pos + 1, __ATOMIC_RELEASE);
+
+   dequeue_pos = __atomic_load_n(&(plane->dequeue_pos), __ATOMIC_RELAXED);
+   depth = (pos + 1) - dequeue_pos;
+   if (depth <= plane->queue_mask + 1 && depth > __atomic_load_n(&(plane->depth_peak), __ATOMIC_RELAXED)) {
+      __atomic_store_n(&(plane->depth_peak), depth, __ATOMIC_RELAXED);
+   }
+
+   return CACHE_SUCCESS;
 }
 
 
-struct dbx_pool_task * dbx_pool_get_task(void)
+/* v2.1.20 up to long_max threads serve the long lane first, so that a steady stream of short requests cannot starve it; at least one thread always serves the short lane first */
+struct dbx_pool_task * dbx_pool_get_task(DBXPOOL *ppool)
 {
    struct dbx_pool_task* task;
 
-#if !defined(_WIN32)
-   pthread_mutex_lock(&dbx_task_queue_mutex);
-#endif
+   if (ppool->long_max < __atomic_load_n(&(ppool->size), __ATOMIC_RELAXED)) {
+      task = dbx_pool_long_get_task(ppool);
+      if (task) {
+         return task;
+      }
+   }
+
+   task = dbx_pool_lane_get_task(&(ppool->lane[DBX_LANE_SHORT]));
+   if (task) {
+      dbx_pool_room(ppool);
+      return task;
+   }
+
+   return dbx_pool_long_get_task(ppool);
+}
+
 
-   if (dbx_total_tasks > 0) {
-      task = tasks;
-      tasks = task->next;
+/* v2.1.20 take a task from the long lane only while fewer than long_max threads are working on it */
+struct dbx_pool_task * dbx_pool_long_get_task(DBXPOOL *ppool)
+{
+   int active;
+   struct dbx_pool_task* task;
 
-      if (tasks == NULL) {
-         bottom_task = NULL;
+   active = __atomic_load_n(&(ppool->long_active), __ATOMIC_RELAXED);
+   while (active < ppool->long_max) {
+      if (__atomic_compare_exchange_n(&(ppool->long_active), &active, active + 1, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+         task = dbx_pool_lane_get_task(&(ppool->lane[DBX_LANE_LONG]));
+         if (!task) {
+            __atomic_sub_fetch(&(ppool->long_active), 1, __ATOMIC_RELEASE);
+         }
+         else {
+            dbx_pool_room(ppool);
+         }
+         return task;
       }
-      dbx_total_tasks --;
    }
-   else {
-      task = NULL;
+
+   return NULL;
+}
+
+
+/* v2.1.20 a task has left the queue: wake any submitter waiting for room (see dbx_pool_add_task) */
+int dbx_pool_room(DBXPOOL *ppool)
+{
+   __atomic_thread_fence(__ATOMIC_SEQ_CST);
+   if (__atomic_load_n(&(ppool->room_waiting), __ATOMIC_RELAXED) > 0) {
+      pthread_mutex_lock(&(ppool->mutex));
+      pthread_cond_broadcast(&(ppool->room));
+      pthread_mutex_unlock(&(ppool->mutex));
    }
+   return 0;
+}
 
-#if !defined(_WIN32)
-   pthread_mutex_unlock(&dbx_task_queue_mutex);
-#endif
+
+struct dbx_pool_task * dbx_pool_lane_get_task(DBXPOOLLANE *plane)
+{
+   long dif;
+   unsigned long pos, seq;
+   unsigned long long wait_ns;
+   DBXPOOLCELL *cell;
+   struct dbx_pool_task* task;
+
+   pos = __atomic_load_n(&(plane->dequeue_pos), __ATOMIC_RELAXED);
+   while (1) {
+      cell = &(plane->queue[pos & plane->queue_mask]);
+      seq = __atomic_load_n(&(cell->sequence), __ATOMIC_ACQUIRE);
+      dif = (long) seq - (long) (pos + 1);
+      if (dif == 0) {
+         if (__atomic_compare_exchange_n(&(plane->dequeue_pos), &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+         }
+      }
+      else if (dif < 0) {
+         return NULL; /* empty */
+      }
+      else {
+         pos = __atomic_load_n(&(plane->dequeue_pos), __ATOMIC_RELAXED);
+      }
+   }
+   task = cell->task;
+   __atomic_store_n(&(cell->sequence), pos + plane->queue_mask + 1, __ATOMIC_RELEASE);
+
+   wait_ns = dbx_clock_ns() - task->enqueue_ns;
+   __atomic_add_fetch(&(plane->tasks), 1, __ATOMIC_RELAXED);
+   __atomic_add_fetch(&(plane->wait_ns_total), wait_ns, __ATOMIC_RELAXED);
+   if (wait_ns > __atomic_load_n(&(plane->wait_ns_max), __ATOMIC_RELAXED)) {
+      __atomic_store_n(&(plane->wait_ns_max), wait_ns, __ATOMIC_RELAXED);
+   }
 
    return task;
 }
 
 
-void dbx_pool_execute_task(struct dbx_pool_task *task, int thread_id)
+/* v2.1.20 run a request taken by dbx_pool_get_task() and give up its place on the long lane */
+void dbx_pool_run_task(DBXPOOL *ppool, struct dbx_pool_task *task, DBXTID *ptid)
+{
+   short lane = task->lane; /* the task belongs to the event loop once it has been executed */
+
+   dbx_pool_execute_task(task, ptid);
+   if (lane == DBX_LANE_LONG) {
+      __atomic_sub_fetch(&(ppool->long_active), 1, __ATOMIC_RELEASE);
+   }
+   return;
+}
+
+
+unsigned long long dbx_clock_ns(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ((unsigned long long) ts.tv_sec * 1000000000ULL) + (unsigned long long) ts.tv_nsec;
+}
+#endif
+
+
+void dbx_pool_execute_task(struct dbx_pool_task *task, DBXTID *ptid)
 {
+   DBXCON *pcon;
+
    if (task) {
 
-      task->pmeth->p_dbxfun(task->pmeth);
+      /* v2.1.20 run the request over the worker's own connection to the server */
+      pcon = NULL;
+      if (ptid && ptid->pcon) {
+         pcon = task->pmeth->pcon;
+         ptid->pcon->error[0] = '\0';
+         ptid->pcon->error_code = 0;
+         task->pmeth->pcon = ptid->pcon;
+#if !defined(_WIN32)
+         dbx_pool_context_check(ptid);
+#endif
+      }
+
+      if (!pcon) { /* v2.1.20 the only thread serving the connection */
+         dbx_request_run(task->pmeth);
+      }
+      else if (ptid->pcon->net_connection) {
+         task->pmeth->p_dbxfun(task->pmeth);
+      }
 
-      task->pmeth->done = 1;
+      if (pcon) { /* v2.1.20 the error belongs to the request: the connection it came from is shared by other threads */
+         if (ptid->pcon->error[0]) {
+            dbx_request_error(task->pmeth);
+         }
+         task->pmeth->pcon = pcon;
+      }
 
 #if !defined(_WIN32)
-      pthread_cond_broadcast(&dbx_result_cond);
+      if (task->pasync) { /* v2.1.20 ownership of the task passes to the event loop */
+         dbx_async_release(task);
+         dbx_async_complete(task);
+         return;
+      }
+#endif
+
+#if !defined(_WIN32)
+      if (task->pmeth->pwait) { /* v2.1.20 wake only the thread waiting for this request */
+         DBXWAIT *pwait = (DBXWAIT *) task->pmeth->pwait;
+
+         pthread_mutex_lock(&(pwait->mutex));
+         pwait->done = 1;
+         pthread_cond_signal(&(pwait->cond));
+         pthread_mutex_unlock(&(pwait->mutex));
+         return;
+      }
 #endif
+
+      task->pmeth->done = 1;
    }
 }
 
 
 void * dbx_pool_requests_loop(void *data)
 {
-   int thread_id;
    DBXTID *ptid;
+#if !defined(_WIN32)
+   DBXPOOL *ppool;
    struct dbx_pool_task *task = NULL;
+#endif
 
    ptid = (DBXTID *) data;
    if (!ptid) {
       return NULL;
    }
 
-   thread_id = ptid->thread_id;
-
 /*
 #if !defined(_WIN32)
 {
@@ -8738,91 +10694,858 @@ void * dbx_pool_requests_loop(void *data)
    ret = pthread_attr_getstacksize(&tattr, &size);
    printf("\r\n*** pthread_attr_getstacksize (pool) %x *** ret=%d; size=%u\r\n", (unsigned long) pthread_self(), ret, size);
 }
-#endif
-*/
+#endif
+*/
+
+#if !defined(_WIN32)
+   ppool = (DBXPOOL *) ptid->ppool;
+
+   if (ptid->connect) { /* v2.1.20 started on demand: connect here rather than hold up the thread that submitted the request */
+      ptid->pcon = dbx_pool_context_open(ppool->ptemplate);
+      ptid->used_ns = dbx_clock_ns();
+      pthread_mutex_lock(&(ppool->mutex));
+      __atomic_sub_fetch(&(ppool->starting), 1, __ATOMIC_RELAXED);
+      if (!ptid->pcon) {
+         __atomic_store_n(&(ppool->grow_failed), 1, __ATOMIC_RELAXED); /* carry on with the threads already connected */
+      }
+      pthread_mutex_unlock(&(ppool->mutex));
+      if (!ptid->pcon) {
+         return NULL;
+      }
+   }
+
+   while (1) {
+      task = dbx_pool_get_task(ppool);
+      if (task) {
+         dbx_pool_run_task(ppool, task, ptid);
+         continue;
+      }
+
+      /* v2.1.20 register as idle before the final check so that a submitter cannot miss us */
+      pthread_mutex_lock(&(ppool->mutex));
+      __atomic_add_fetch(&(ppool->idle), 1, __ATOMIC_SEQ_CST);
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      task = dbx_pool_get_task(ppool);
+      if (!task) {
+         if (ppool->stop) { /* the queue is drained before the pool shuts down */
+            __atomic_sub_fetch(&(ppool->idle), 1, __ATOMIC_SEQ_CST);
+            pthread_mutex_unlock(&(ppool->mutex));
+            break;
+         }
+         pthread_cond_wait(&(ppool->cond), &(ppool->mutex));
+      }
+      __atomic_sub_fetch(&(ppool->idle), 1, __ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&(ppool->mutex));
+
+      if (task) {
+         dbx_pool_run_task(ppool, task, ptid);
+      }
+   }
+#endif
+
+   return NULL;
+}
+
+
+#if !defined(_WIN32)
+
+/* v2.1.20 Start a pool of 'size' database threads, each with its own connection to the server if 'own_context' is set */
+/* v2.1.20 with 'pool_min' set, only that many threads are started here: the rest are added as the load requires */
+DBXPOOL * dbx_pool_create(DBXCON *pcon, int size, short own_context)
+{
+   int n, lane, start;
+   DBXPOOL *ppool;
+
+   if (size < 1) {
+      size = 1;
+   }
+   if (size > DBX_THREADPOOL_MAX) {
+      size = DBX_THREADPOOL_MAX;
+   }
+
+   ppool = (DBXPOOL *) dbx_malloc(sizeof(DBXPOOL), 601);
+   if (!ppool) {
+      return NULL;
+   }
+   memset((void *) ppool, 0, sizeof(DBXPOOL));
+   ppool->ptid = (DBXTID *) dbx_malloc(sizeof(DBXTID) * size, 601);
+   ppool->pthreads = (pthread_t *) dbx_malloc(sizeof(pthread_t) * size, 601);
+   for (lane = 0; lane < DBX_POOL_LANES; lane ++) {
+      ppool->lane[lane].queue = (DBXPOOLCELL *) dbx_malloc(sizeof(DBXPOOLCELL) * DBX_POOL_QUEUE_SIZE, 601);
+   }
+   if (!ppool->ptid || !ppool->pthreads || !ppool->lane[DBX_LANE_SHORT].queue || !ppool->lane[DBX_LANE_LONG].queue) {
+      if (ppool->ptid) {
+         dbx_free((void *) ppool->ptid, 601);
+      }
+      if (ppool->pthreads) {
+         dbx_free((void *) ppool->pthreads, 601);
+      }
+      for (lane = 0; lane < DBX_POOL_LANES; lane ++) {
+         if (ppool->lane[lane].queue) {
+            dbx_free((void *) ppool->lane[lane].queue, 601);
+         }
+      }
+      dbx_free((void *) ppool, 601);
+      return NULL;
+   }
+   for (lane = 0; lane < DBX_POOL_LANES; lane ++) {
+      ppool->lane[lane].queue_mask = DBX_POOL_QUEUE_SIZE - 1;
+      for (n = 0; n < DBX_POOL_QUEUE_SIZE; n ++) {
+         ppool->lane[lane].queue[n].sequence = (unsigned long) n;
+         ppool->lane[lane].queue[n].task = NULL;
+      }
+   }
+   pthread_mutex_init(&(ppool->mutex), NULL);
+   pthread_cond_init(&(ppool->cond), NULL);
+   pthread_cond_init(&(ppool->room), NULL);
+
+   /* v2.1.20 by default, up to half of the threads (and at least one) may work on long running requests */
+   ppool->long_max = pcon->long_threads > 0 ? pcon->long_threads : (size + 1) / 2;
+   if (ppool->long_max > size) {
+      ppool->long_max = size;
+   }
+
+   ppool->size_max = size;
+   start = size;
+   if (own_context && pcon->pool_min > 0 && pcon->pool_min < size) {
+      ppool->ptemplate = (DBXCON *) dbx_malloc(sizeof(DBXCON), 901);
+      if (ppool->ptemplate) {
+         memcpy((void *) ppool->ptemplate, (void *) pcon, sizeof(DBXCON));
+         ppool->ptemplate->rbuf = NULL;
+         start = pcon->pool_min;
+      }
+   }
+
+   for (n = 0; n < start; n ++) {
+      if (dbx_pool_start_thread(ppool, pcon, own_context) != CACHE_SUCCESS) {
+         break;
+      }
+   }
+
+   if (ppool->size == 0) {
+      dbx_pool_shutdown(ppool);
+      return NULL;
+   }
+
+   return ppool;
+}
+
+
+/* v2.1.20 Start the pool's next thread: with no 'pcon' the thread makes its own connection to the server from the pool's template */
+int dbx_pool_start_thread(DBXPOOL *ppool, DBXCON *pcon, short own_context)
+{
+   int n;
+   DBXCON *pcon_params;
+   pthread_attr_t attr;
+   size_t stacksize, newstacksize;
+
+   n = ppool->size;
+   if (n >= ppool->size_max) {
+      return CACHE_FAILURE;
+   }
+   pcon_params = pcon ? pcon : ppool->ptemplate;
+
+   pthread_attr_init(&attr);
+
+   stacksize = 0;
+   pthread_attr_getstacksize(&attr, &stacksize);
+
+   newstacksize = DBX_THREAD_STACK_SIZE;
+/*
+   printf("Thread Pool: default stack=%lu; new stack=%lu;\n", (unsigned long) stacksize, (unsigned long) newstacksize);
+*/
+   pthread_attr_setstacksize(&attr, newstacksize);
+
+   ppool->ptid[n].thread_id = n;
+   ppool->ptid[n].p_mutex = pcon_params->p_mutex;
+   ppool->ptid[n].p_zv = pcon_params->p_zv;
+   ppool->ptid[n].ppool = (void *) ppool;
+   ppool->ptid[n].pcon = NULL;
+   ppool->ptid[n].connect = 0;
+   ppool->ptid[n].used_ns = dbx_clock_ns();
+
+   if (own_context && pcon) {
+      ppool->ptid[n].pcon = dbx_pool_context_open(pcon);
+      if (!ppool->ptid[n].pcon && n > 0) { /* run with the connections already made */
+         pthread_attr_destroy(&attr);
+         return CACHE_FAILURE;
+      }
+   }
+   else if (own_context) {
+      ppool->ptid[n].connect = 1;
+      __atomic_add_fetch(&(ppool->starting), 1, __ATOMIC_RELAXED);
+   }
+
+   if (pthread_create(&(ppool->pthreads[n]), &attr, dbx_pool_requests_loop, (void *) &(ppool->ptid[n]))) {
+      dbx_pool_context_close(ppool->ptid[n].pcon);
+      if (ppool->ptid[n].connect) {
+         __atomic_sub_fetch(&(ppool->starting), 1, __ATOMIC_RELAXED);
+         __atomic_store_n(&(ppool->grow_failed), 1, __ATOMIC_RELAXED);
+      }
+      pthread_attr_destroy(&attr);
+      return CACHE_FAILURE;
+   }
+   pthread_attr_destroy(&attr);
+   __atomic_store_n(&(ppool->size), n + 1, __ATOMIC_RELEASE);
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 Add a thread while every thread is busy: one at a time, so that a burst of requests does not open every connection at once */
+int dbx_pool_grow(DBXPOOL *ppool)
+{
+   int rc;
+
+   rc = CACHE_FAILURE;
+   pthread_mutex_lock(&(ppool->mutex));
+   if (!ppool->stop && !ppool->grow_failed && !ppool->starting && ppool->size < ppool->size_max && __atomic_load_n(&(ppool->idle), __ATOMIC_RELAXED) == 0) {
+      rc = dbx_pool_start_thread(ppool, NULL, 1);
+   }
+   pthread_mutex_unlock(&(ppool->mutex));
+
+   return rc;
+}
+
+
+/* v2.1.20 Stop the pool once queued requests have been processed and release its resources */
+int dbx_pool_shutdown(DBXPOOL *ppool)
+{
+   int n;
+   struct dbx_pool_task *task;
+
+   if (!ppool) {
+      return 0;
+   }
+
+   pthread_mutex_lock(&(ppool->mutex));
+   __atomic_store_n(&(ppool->stop), 1, __ATOMIC_RELAXED);
+   pthread_cond_broadcast(&(ppool->cond));
+   pthread_cond_broadcast(&(ppool->room));
+   pthread_mutex_unlock(&(ppool->mutex));
+
+   for (n = 0; n < ppool->size; n ++) {
+      pthread_join(ppool->pthreads[n], NULL);
+      dbx_pool_context_close(ppool->ptid[n].pcon);
+   }
+
+   /* v2.1.20 anything queued by another thread as the pool was stopping is run here */
+   while ((task = dbx_pool_get_task(ppool))) {
+      dbx_pool_run_task(ppool, task, NULL);
+   }
+
+   pthread_cond_destroy(&(ppool->cond));
+   pthread_cond_destroy(&(ppool->room));
+   pthread_mutex_destroy(&(ppool->mutex));
+   for (n = 0; n < DBX_POOL_LANES; n ++) {
+      dbx_free((void *) ppool->lane[n].queue, 601);
+   }
+   if (ppool->ptemplate) {
+      dbx_free((void *) ppool->ptemplate, 901);
+   }
+   dbx_free((void *) ppool->pthreads, 601);
+   dbx_free((void *) ppool->ptid, 601);
+   dbx_free((void *) ppool, 601);
+
+   return 0;
+}
+
+
+/* v2.1.20 Open a further connection to the server for the exclusive use of one worker */
+DBXCON * dbx_pool_context_open(DBXCON *pcon)
+{
+   int rc;
+   DBXCON *pcon_worker;
+
+   pcon_worker = (DBXCON *) dbx_malloc(sizeof(DBXCON), 901);
+   if (!pcon_worker) {
+      return NULL;
+   }
+   memcpy((void *) pcon_worker, (void *) pcon, sizeof(DBXCON));
+   pcon_worker->use_mutex = 0;
+   pcon_worker->net_connection = 0;
+   pcon_worker->cli_socket = (SOCKET) 0;
+   pcon_worker->rbuf = NULL; /* v2.1.20 */
+   pcon_worker->rbuf_pos = 0;
+   pcon_worker->rbuf_len = 0;
+   pcon_worker->error[0] = '\0';
+   pcon_worker->pmeth_base = NULL;
+   pcon_worker->pmeth_pool = NULL;
+   pcon_worker->pasync = NULL;
+   pcon_worker->ppool = NULL;
+
+   if (pcon->ppipe) { /* v2.1.20 requests are pipelined over the connection's own socket */
+      pcon_worker->p_zv = &(pcon_worker->zv);
+      pcon_worker->net_connection = 1;
+      return pcon_worker;
+   }
+
+   rc = netx_tcp_connect(pcon_worker, 0);
+   if (rc == CACHE_SUCCESS) {
+      pcon_worker->p_zv = &(pcon_worker->zv);
+      rc = netx_tcp_handshake(pcon_worker, 0);
+   }
+   if (rc != CACHE_SUCCESS) {
+      dbx_free((void *) pcon_worker, 901);
+      return NULL;
+   }
+   pcon_worker->net_connection = 1;
+
+   return pcon_worker;
+}
+
+
+/* v2.1.20 Replace a worker's connection to the server after it has been lost */
+int dbx_pool_context_reconnect(DBXCON *pcon_worker)
+{
+   int rc;
+
+   netx_tcp_disconnect(pcon_worker, 0);
+   pcon_worker->cli_socket = (SOCKET) 0;
+   pcon_worker->eof = 0;
+
+   rc = netx_tcp_connect(pcon_worker, 0);
+   if (rc == CACHE_SUCCESS) {
+      rc = netx_tcp_handshake(pcon_worker, 0);
+   }
+   if (rc != CACHE_SUCCESS) {
+      netx_tcp_disconnect(pcon_worker, 0);
+      pcon_worker->cli_socket = (SOCKET) 0;
+      if (!pcon_worker->error[0]) {
+         T_STRCPY(pcon_worker->error, _dbxso(pcon_worker->error), "Connection to the server lost");
+      }
+      return rc;
+   }
+   pcon_worker->net_connection = 1;
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 Before a request is sent over a worker's connection, check one that has been idle for a while (the server may have closed it) and replace one that has been lost */
+int dbx_pool_context_check(DBXTID *ptid)
+{
+   int rc;
+   unsigned long long now;
+   DBXCON *pcon_worker;
+
+   pcon_worker = ptid->pcon;
+   if (pcon_worker->ppipe) { /* the reader thread looks after a pipelined connection */
+      return CACHE_SUCCESS;
+   }
+   now = dbx_clock_ns();
+   rc = CACHE_SUCCESS;
+   if (pcon_worker->net_connection && (now - ptid->used_ns) > DBX_POOL_IDLE_CHECK_NS) {
+      rc = netx_tcp_alive(pcon_worker, 0);
+   }
+   if (rc != CACHE_SUCCESS || !pcon_worker->net_connection) {
+      rc = dbx_pool_context_reconnect(pcon_worker);
+      if (ptid->ppool) {
+         __atomic_add_fetch(&(((DBXPOOL *) ptid->ppool)->reconnects), 1, __ATOMIC_RELAXED);
+      }
+   }
+   ptid->used_ns = now;
+
+   return rc;
+}
+
+
+/* v2.1.20 PRIMARY THREAD : attach a connection to the broker's connection for the same server, namespace and credentials, making it if necessary */
+int dbx_broker_attach(DBXCON *pcon)
+{
+   int rc;
+   char key[512];
+   DBXBROKER *pbroker;
+   DBXCON *pmaster;
+   DBXPOOL *ppool;
+
+   T_SPRINTF(key, _dbxso(key), "%d:%s:%d:%s:%s:%s:%d:%d", pcon->dbtype, pcon->net_host, pcon->tcp_port, pcon->nspace, pcon->username, pcon->password, pcon->pool_size, pcon->pool_min);
+
+   rc = CACHE_SUCCESS;
+   dbx_enter_critical_section((void *) &dbx_async_mutex);
+
+   for (pbroker = dbx_broker_head; pbroker; pbroker = pbroker->pnext) {
+      if (!strcmp(pbroker->key, key)) {
+         break;
+      }
+   }
+
+   if (!pbroker) {
+      pbroker = (DBXBROKER *) dbx_malloc(sizeof(DBXBROKER), 901);
+      pmaster = (DBXCON *) dbx_malloc(sizeof(DBXCON), 901);
+      if (!pbroker || !pmaster) {
+         if (pbroker) {
+            dbx_free((void *) pbroker, 901);
+         }
+         if (pmaster) {
+            dbx_free((void *) pmaster, 901);
+         }
+         dbx_leave_critical_section((void *) &dbx_async_mutex);
+         T_STRCPY(pcon->error, _dbxso(pcon->error), "Unable to allocate memory for the shared connection");
+         return CACHE_NOCON;
+      }
+      memcpy((void *) pmaster, (void *) pcon, sizeof(DBXCON));
+      pmaster->error[0] = '\0';
+      pmaster->pmeth_base = NULL;
+      pmaster->pmeth_pool = NULL;
+      pmaster->pasync = NULL;
+      pmaster->ppool = NULL;
+      pmaster->pbroker = NULL;
+      pmaster->cli_socket = (SOCKET) 0;
+      pmaster->rbuf = NULL;
+      pmaster->mutex_net.created = 0;
+      dbx_mutex_create(&(pmaster->mutex_net));
+      pmaster->p_mutex = &(pmaster->mutex_net);
+
+      rc = netx_tcp_connect(pmaster, 0);
+      if (rc == CACHE_SUCCESS) {
+         pmaster->p_zv = &(pmaster->zv);
+         rc = netx_tcp_handshake(pmaster, 0);
+      }
+      ppool = NULL;
+      if (rc == CACHE_SUCCESS && pmaster->net_revision == 2) {
+         rc = netx_pipe_open(pmaster);
+      }
+      if (rc == CACHE_SUCCESS) {
+         pmaster->net_connection = 1;
+         /* every thread has its own connection to the server, so the broker's pool serves the requests of any isolate */
+         ppool = dbx_pool_create(pmaster, pmaster->pool_size, 1);
+         if (!ppool || !ppool->ptid[0].pcon) {
+            T_STRCPY(pmaster->error, _dbxso(pmaster->error), "Unable to connect the threads of the shared connection to the server");
+            rc = CACHE_NOCON;
+         }
+      }
+      if (rc != CACHE_SUCCESS) {
+         dbx_leave_critical_section((void *) &dbx_async_mutex);
+         T_STRCPY(pcon->error, _dbxso(pcon->error), pmaster->error);
+         dbx_pool_shutdown(ppool);
+         netx_pipe_close(pmaster);
+         netx_tcp_disconnect(pmaster, 0);
+         dbx_mutex_destroy(&(pmaster->mutex_net));
+         dbx_free((void *) pmaster, 901);
+         dbx_free((void *) pbroker, 901);
+         return CACHE_NOCON;
+      }
+      pmaster->ppool = (void *) ppool;
+
+      T_STRCPY(pbroker->key, _dbxso(pbroker->key), key);
+      pbroker->refs = 0;
+      pbroker->pcon = pmaster;
+      pbroker->pnext = dbx_broker_head;
+      dbx_broker_head = pbroker;
+   }
+
+   pbroker->refs ++;
+   pmaster = pbroker->pcon;
+   dbx_leave_critical_section((void *) &dbx_async_mutex);
+
+   /* requests are sent by the broker's threads: this connection has no socket of its own */
+   pcon->pbroker = (void *) pbroker;
+   pcon->ppool = pmaster->ppool;
+   memcpy((void *) &(pcon->zv), (void *) &(pmaster->zv), sizeof(DBXZV));
+   pcon->p_zv = &(pcon->zv);
+   pcon->mutex_net.created = 0;
+   dbx_mutex_create(&(pcon->mutex_net));
+   pcon->p_mutex = &(pcon->mutex_net);
+   pcon->cli_socket = (SOCKET) 0;
+   pcon->net_connection = 1;
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 PRIMARY THREAD : the broker's connection (and pool) is closed with the last connection attached to it */
+int dbx_broker_detach(DBXCON *pcon)
+{
+   DBXBROKER *pbroker, **ppbroker;
+   DBXCON *pmaster;
+
+   pbroker = (DBXBROKER *) pcon->pbroker;
+   pcon->pbroker = NULL;
+   if (!pbroker) {
+      return 0;
+   }
+
+   dbx_enter_critical_section((void *) &dbx_async_mutex);
+   pbroker->refs --;
+   if (pbroker->refs > 0) {
+      dbx_leave_critical_section((void *) &dbx_async_mutex);
+      return 0;
+   }
+   for (ppbroker = &dbx_broker_head; *ppbroker; ppbroker = &((*ppbroker)->pnext)) {
+      if (*ppbroker == pbroker) {
+         *ppbroker = pbroker->pnext;
+         break;
+      }
+   }
+   dbx_leave_critical_section((void *) &dbx_async_mutex);
+
+   pmaster = pbroker->pcon;
+   dbx_pool_shutdown((DBXPOOL *) pmaster->ppool);
+   netx_pipe_close(pmaster);
+   netx_tcp_disconnect(pmaster, 0);
+   dbx_mutex_destroy(&(pmaster->mutex_net));
+   dbx_free((void *) pmaster, 901);
+   dbx_free((void *) pbroker, 901);
+
+   return 0;
+}
+
+
+/* v2.1.20 PRIMARY THREAD : a connection attached to the broker has no socket: its synchronous requests are sent by one of the broker's threads */
+int dbx_broker_command(DBXMETH *pmeth, int command, int context)
+{
+   int (* p_dbxfun) (struct tagDBXMETH * pmeth);
+
+   p_dbxfun = pmeth->p_dbxfun;
+   pmeth->net_command = command;
+   pmeth->net_context = context;
+   pmeth->net_rc = CACHE_SUCCESS;
+   pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_broker_execute;
+
+   dbx_pool_submit_task(pmeth);
+
+   pmeth->p_dbxfun = p_dbxfun;
+   if (pmeth->error[0]) { /* the caller reports the error from its own connection */
+      T_STRCPY(pmeth->pcon->error, _dbxso(pmeth->pcon->error), pmeth->error);
+      pmeth->pcon->error_code = pmeth->error_code;
+   }
+   return pmeth->net_rc;
+}
+
+
+/* v2.1.20 BROKER THREAD : the request block has been switched to this thread's own connection */
+int dbx_broker_execute(DBXMETH *pmeth)
+{
+   if (pmeth->pcon->pbroker) { /* no connection of our own (the pool is shutting down) */
+      T_STRCPY(pmeth->pcon->error, _dbxso(pmeth->pcon->error), "Connection to the server lost");
+      pmeth->net_rc = CACHE_NOCON;
+      return pmeth->net_rc;
+   }
+   pmeth->net_rc = netx_tcp_command(pmeth, pmeth->net_command, pmeth->net_context);
+   return pmeth->net_rc;
+}
+
+
+int dbx_pool_context_close(DBXCON *pcon_worker)
+{
+   if (!pcon_worker) {
+      return 0;
+   }
+   netx_tcp_disconnect(pcon_worker, 0);
+   dbx_free((void *) pcon_worker, 901);
+
+   return 0;
+}
+
+#endif
+
+
+int dbx_pool_submit_task(DBXMETH *pmeth)
+{
+#if !defined(_WIN32)
+   DBXWAIT wait; /* v2.1.20 */
+
+   pthread_mutex_init(&(wait.mutex), NULL);
+   pthread_cond_init(&(wait.cond), NULL);
+   wait.done = 0;
+   pmeth->done = 0;
+   pmeth->pwait = (void *) &wait;
+
+   if (!dbx_pool_add_task(pmeth, NULL, NULL, NULL, 1)) { /* v2.1.20 no pool (connection closed): run on this thread */
+      pmeth->pwait = NULL;
+      pthread_cond_destroy(&(wait.cond));
+      pthread_mutex_destroy(&(wait.mutex));
+      dbx_request_run(pmeth);
+      pmeth->done = 1;
+      return 1;
+   }
+
+   pthread_mutex_lock(&(wait.mutex));
+   while (!wait.done) {
+      pthread_cond_wait(&(wait.cond), &(wait.mutex));
+   }
+   pthread_mutex_unlock(&(wait.mutex));
+
+   pmeth->pwait = NULL;
+   pmeth->done = 1;
+   pthread_cond_destroy(&(wait.cond));
+   pthread_mutex_destroy(&(wait.mutex));
+#endif
+   return 1;
+}
+
+
+#if !defined(_WIN32)
+
+/* v2.1.20 PRIMARY THREAD : start the event-loop transport for a network connection opened with {transport: "uv"} */
+int dbx_uv_open(DBXCON *pcon, v8::Isolate *isolate)
+{
+   uv_loop_t *loop;
+
+   if (pcon->transport != DBX_TRANSPORT_UV || !pcon->net_connection || pcon->pbroker || pcon->puv) {
+      return CACHE_SUCCESS;
+   }
+
+#if DBX_NODE_VERSION >= 120000
+   loop = GetCurrentEventLoop(isolate);
+#else
+   loop = uv_default_loop();
+#endif
+
+   if (netx_uv_open(pcon, loop) == CACHE_SUCCESS) {
+      return CACHE_SUCCESS;
+   }
+
+   /* the server does not support revision 2 of the protocol (or a connection failed): fall back to the pool of threads */
+   pcon->transport = DBX_TRANSPORT_THREADS;
+   pcon->error[0] = '\0';
+   pcon->ppool = (void *) dbx_pool_create(pcon, pcon->pool_size, (short) (pcon->pool_size > 1));
+   return CACHE_FAILURE;
+}
+
+
+/* v2.1.20 The network command for a request whose function does nothing else: 0 for one that must be run by a thread */
+int dbx_net_command(DBXMETH *pmeth)
+{
+   int n;
+   static const struct {
+      int (* p_dbxfun) (struct tagDBXMETH * pmeth);
+      int command;
+   } dbx_net_commands[] = {
+      {dbx_get,         DBX_CMND_GGET},
+      {dbx_set,         DBX_CMND_GSET},
+      {dbx_defined,     DBX_CMND_GDEFINED},
+      {dbx_delete,      DBX_CMND_GDELETE},
+      {dbx_next,        DBX_CMND_GNEXT},
+      {dbx_previous,    DBX_CMND_GPREVIOUS},
+      {dbx_increment,   DBX_CMND_GINCREMENT},
+      {dbx_function,    DBX_CMND_FUNCTION},
+      {dbx_classmethod, DBX_CMND_CCMETH},
+      {dbx_method,      DBX_CMND_CMETH},
+      {dbx_setproperty, DBX_CMND_CSETP},
+      {dbx_getproperty, DBX_CMND_CGETP},
+      {NULL,            0}
+   };
+
+   for (n = 0; dbx_net_commands[n].p_dbxfun; n ++) {
+      if (pmeth->p_dbxfun == dbx_net_commands[n].p_dbxfun) {
+         return dbx_net_commands[n].command;
+      }
+   }
+   return 0;
+}
+
+
+/* v2.1.20 Create the completion channel for a connection on the event loop of the calling thread */
+DBXASYNC * dbx_async_open(DBXCON *pcon, uv_loop_t *loop)
+{
+   DBXASYNC *pasync;
+
+   pasync = (DBXASYNC *) dbx_malloc(sizeof(DBXASYNC), 601);
+   if (!pasync) {
+      return NULL;
+   }
+   pasync->phead = NULL;
+   pasync->ptail = NULL;
+   pasync->pending = 0;
+   pasync->closing = 0;
+   pthread_mutex_init(&(pasync->mutex), NULL);
+   pthread_cond_init(&(pasync->admit_cond), NULL);
+
+   if (uv_async_init(loop, &(pasync->async), dbx_async_drain)) {
+      pthread_mutex_destroy(&(pasync->mutex));
+      pthread_cond_destroy(&(pasync->admit_cond));
+      dbx_free((void *) pasync, 601);
+      return NULL;
+   }
+   pasync->async.data = (void *) pasync;
+   uv_unref((uv_handle_t *) &(pasync->async)); /* only outstanding requests keep the loop alive */
+
+   pcon->pasync = (void *) pasync;
+   return pasync;
+}
 
-#if !defined(_WIN32)
-   pthread_mutex_lock(&dbx_pool_mutex);
 
-   while (1) {
-      if (dbx_total_tasks > 0) {
-         task = dbx_pool_get_task();
-         if (task) {
-            pthread_mutex_unlock(&dbx_pool_mutex);
-            dbx_pool_execute_task(task, thread_id);
-            dbx_free(task, 3001);
-            pthread_mutex_lock(&dbx_pool_mutex);
+/* PRIMARY THREAD */
+int dbx_async_submit(DBXASYNC *pasync, DBXMETH *pmeth, void *req, void *after_work_cb)
+{
+   int command;
+
+   pmeth->done = 0;
+   pmeth->pwait = NULL;
+   __atomic_add_fetch(&(pmeth->pcon->inflight), 1, __ATOMIC_SEQ_CST); /* v2.1.20 */
+
+   /* v2.1.20 a request that is no more than a command to the server is sent by the event loop itself */
+   if (pmeth->pcon->puv && (command = dbx_net_command(pmeth))) {
+      pmeth->task.task_id = 6;
+      pmeth->task.pmeth = pmeth;
+      pmeth->task.next = NULL;
+      pmeth->task.pasync = (void *) pasync;
+      pmeth->task.req = req;
+      pmeth->task.after_work_cb = after_work_cb;
+      if (netx_uv_command(pmeth, command) == CACHE_SUCCESS) {
+         if (pasync->pending ++ == 0) {
+            uv_ref((uv_handle_t *) &(pasync->async));
          }
-      }
-      else {
-         pthread_cond_wait(&dbx_pool_cond, &dbx_pool_mutex);
+         return CACHE_SUCCESS;
       }
    }
-#endif
 
-   return NULL;
+   if (!dbx_pool_add_task(pmeth, (void *) pasync, req, after_work_cb, 0)) {
+      __atomic_sub_fetch(&(pmeth->pcon->inflight), 1, __ATOMIC_SEQ_CST);
+      return CACHE_FAILURE;
+   }
+   if (pasync->pending ++ == 0) {
+      uv_ref((uv_handle_t *) &(pasync->async));
+   }
+   return CACHE_SUCCESS;
 }
 
 
-int dbx_pool_thread_init(DBXCON *pcon, int num_threads)
+/* POOL THREAD */
+void dbx_async_complete(struct dbx_pool_task *task)
 {
-#if !defined(_WIN32)
-   int iterator;
-   pthread_attr_t attr[DBX_THREADPOOL_MAX];
-   size_t stacksize, newstacksize;
-
-   for (iterator = 0; iterator < num_threads; iterator ++) {
+   DBXASYNC *pasync = (DBXASYNC *) task->pasync;
 
-      pthread_attr_init(&attr[iterator]);
+   task->next = NULL;
+   pthread_mutex_lock(&(pasync->mutex));
+   if (pasync->ptail) {
+      pasync->ptail->next = task;
+   }
+   else {
+      pasync->phead = task;
+   }
+   pasync->ptail = task;
+   pthread_mutex_unlock(&(pasync->mutex));
 
-      stacksize = 0;
-      pthread_attr_getstacksize(&attr[iterator], &stacksize);
+   uv_async_send(&(pasync->async));
+   return;
+}
 
-      newstacksize = DBX_THREAD_STACK_SIZE;
-/*
-      printf("Thread Pool: default stack=%lu; new stack=%lu;\n", (unsigned long) stacksize, (unsigned long) newstacksize);
-*/
-      pthread_attr_setstacksize(&attr[iterator], newstacksize);
 
-      dbx_thr_id[iterator].thread_id = iterator;
-      dbx_thr_id[iterator].p_mutex = pcon->p_mutex;
-      dbx_thr_id[iterator].p_zv = pcon->p_zv;
-      
-      pthread_create(&dbx_p_threads[iterator], &attr[iterator], dbx_pool_requests_loop, (void *) &dbx_thr_id[iterator]);
+/* POOL THREAD : the request has left the DB thread: wake a submitter blocked by admission control */
+void dbx_async_release(struct dbx_pool_task *task)
+{
+   DBXCON *pcon = task->pmeth->pcon;
+   DBXASYNC *pasync = (DBXASYNC *) task->pasync;
 
+   __atomic_sub_fetch(&(pcon->inflight), 1, __ATOMIC_SEQ_CST);
+   if (__atomic_load_n(&(pcon->admit_waiting), __ATOMIC_SEQ_CST)) {
+      pthread_mutex_lock(&(pasync->mutex));
+      pthread_cond_signal(&(pasync->admit_cond));
+      pthread_mutex_unlock(&(pasync->mutex));
    }
-#endif
-   return 0;
+   return;
 }
 
 
-int dbx_pool_submit_task(DBXMETH *pmeth)
+/* PRIMARY THREAD : deliver the results of the requests completed since the last wake-up, up to DBX_ASYNC_DRAIN_MAX at a time */
+void dbx_async_drain(uv_async_t *handle)
 {
-#if !defined(_WIN32)
-   struct timespec   ts;
-   struct timeval    tp;
+   int n;
+   DBXASYNC *pasync = (DBXASYNC *) handle->data;
+   struct dbx_pool_task *task, *task_next, *task_tail;
+   DBX_DBNAME::dbx_baton_t *baton;
+   DBX_DBNAME *c;
+   uv_work_t *req;
+
+   pthread_mutex_lock(&(pasync->mutex));
+   task = pasync->phead;
+   task_tail = pasync->ptail;
+   pasync->phead = NULL;
+   pasync->ptail = NULL;
+   pthread_mutex_unlock(&(pasync->mutex));
+
+   if (!task) {
+      return;
+   }
 
-   pmeth->done = 0;
+   Isolate* isolate = Isolate::GetCurrent();
+   HandleScope scope(isolate);
 
-   dbx_pool_add_task(pmeth);
+   req = (uv_work_t *) task->req;
+   baton = static_cast<DBX_DBNAME::dbx_baton_t *>(req->data);
+   c = baton->c;
+
+   {
+#if DBX_NODE_VERSION >= 100000
+      /* one callback scope for the batch: the microtask queue is processed once all of its callbacks have run */
+      node::async_context actx = {0, 0};
+      node::CallbackScope cscope(isolate, c->handle(), actx);
+#endif
 
-   pthread_mutex_lock(&dbx_result_mutex);
+      for (n = 0; task && n < DBX_ASYNC_DRAIN_MAX; n ++) {
+         task_next = task->next;
+         req = (uv_work_t *) task->req;
+         baton = static_cast<DBX_DBNAME::dbx_baton_t *>(req->data);
+         c = baton->c;
+         c->dbx_count += 1;
+         pasync->pending --;
+         ((async_rtn (*) (uv_work_t *)) task->after_work_cb)(req);
+         task = task_next;
+      }
 
-   while (!pmeth->done) {
+      if (c->pcon && c->pcon->max_inflight > 0) { /* v2.1.20 admit requests held back while the connection was saturated */
+         DBX_DBNAME::dbx_admit_drain(c);
+      }
+   }
 
-      gettimeofday(&tp, NULL);
-      ts.tv_sec  = tp.tv_sec;
-      ts.tv_nsec = tp.tv_usec * 1000;
-      ts.tv_sec += 3;
+   if (task) { /* return the rest to the front of the queue and yield to the event loop */
+      pthread_mutex_lock(&(pasync->mutex));
+      task_tail->next = pasync->phead;
+      if (!pasync->phead) {
+         pasync->ptail = task_tail;
+      }
+      pasync->phead = task;
+      pthread_mutex_unlock(&(pasync->mutex));
+      uv_async_send(handle);
+      return;
+   }
 
-      pthread_cond_timedwait(&dbx_result_cond, &dbx_result_mutex, &ts);
+   if (pasync->pending == 0) {
+      if (pasync->closing == 1) {
+         pasync->closing = 2;
+         uv_close((uv_handle_t *) &(pasync->async), dbx_async_close_callback);
+      }
+      else if (pasync->closing == 0) {
+         uv_unref((uv_handle_t *) &(pasync->async));
+      }
    }
+   return;
+}
 
-   pthread_mutex_unlock(&dbx_result_mutex);
-#endif
-   return 1;
+
+void dbx_async_close_callback(uv_handle_t *handle)
+{
+   DBXASYNC *pasync = (DBXASYNC *) handle->data;
+
+   pthread_mutex_destroy(&(pasync->mutex));
+   pthread_cond_destroy(&(pasync->admit_cond));
+   dbx_free((void *) pasync, 601);
+   return;
+}
+
+
+/* PRIMARY THREAD : the channel is released once any outstanding requests have been delivered */
+int dbx_async_close(DBXCON *pcon)
+{
+   DBXASYNC *pasync = (DBXASYNC *) pcon->pasync;
+
+   if (!pasync) {
+      return 0;
+   }
+   pcon->pasync = NULL;
+   pasync->closing = 1;
+   if (pasync->pending == 0) { /* may be called from within dbx_async_drain() */
+      pasync->closing = 2;
+      uv_close((uv_handle_t *) &(pasync->async), dbx_async_close_callback);
+   }
+   return 0;
 }
 
+#endif
+
 
 int dbx_add_block_size(unsigned char *block, unsigned long offset, unsigned long data_len, int dsort, int dtype)
 {
@@ -8891,78 +11614,462 @@ void * dbx_realloc(void *p, int curr_size, int new_size, short id)
 }
 
 
+/*
+   v2.1.20 Allocations of up to 64KB are served from per-size-class free-lists.
+   The classes are powers of two from 32 bytes, plus one sized for the request block's input buffer.
+   Each thread holds its own free-lists (DBXMEMCACHE) so neither dbx_malloc() nor dbx_free() takes a lock;
+   a block released on a thread other than the one that allocated it joins the releasing thread's lists.
+   Every block carries a DBXMEMHDR recording its size class and the tag it was allocated
+   under, so the byte and count accounting is charged to the allocating subsystem.
+   A thread's accounting is added to the process totals with atomic operations every
+   DBX_MEM_FLUSH_OPS calls, once DBX_MEM_FLUSH_BYTES have moved and when the thread exits.
+   The tag passed to dbx_free() is retained for compatibility only.
+   Tags are grouped by hundreds (see dbx_mem_tag_names):
+   0 general, 201 request blocks, 301 buffer growth, 401 global references, 501 cursors,
+   601 pool tasks, 701 SQL, 801 error buffers and 901 connections.
+*/
+
 void * dbx_malloc(int size, short id)
 {
+   int sclass, tag;
    void *p;
+   DBXMEMHDR *phdr;
+   DBXMEMCACHE *pcache, cache;
+
+   if (size < 0) {
+      return NULL;
+   }
+
+   sclass = dbx_mem_class(size);
+   tag = dbx_mem_tag_index(id);
+   phdr = NULL;
 
+   pcache = dbx_mem_cache();
+   if (!pcache) { /* the thread is exiting: account directly in the process totals */
+      memset((void *) &cache, 0, sizeof(DBXMEMCACHE));
+      pcache = &cache;
+   }
+
+   if (sclass >= 0 && pcache->class_free[sclass]) {
+      phdr = (DBXMEMHDR *) pcache->class_free[sclass];
+      pcache->class_free[sclass] = *((void **) (phdr + 1));
+      pcache->class_idle[sclass] --;
+      pcache->delta.class_idle_bytes -= dbx_mem_class_size[sclass];
+      pcache->delta.class_hits ++;
+   }
+   else {
+      size_t alloc_size = (size_t) (sclass >= 0 ? dbx_mem_class_size[sclass] : size) + sizeof(DBXMEMHDR);
 #if defined(_WIN32)
-      p = (void *) HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, size + 32);
+      p = (void *) HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, alloc_size + 32);
 #else
-   p = (void *) malloc(size);
+      p = (void *) malloc(alloc_size);
 #endif
+      if (!p) {
+         return NULL;
+      }
+      phdr = (DBXMEMHDR *) p;
+      if (sclass >= 0) {
+         pcache->delta.class_misses ++;
+      }
+   }
 
-   return p;
+   phdr->magic = DBX_MEM_MAGIC;
+   phdr->sclass = (short) sclass;
+   phdr->tag = (short) tag;
+   phdr->size = (unsigned int) size;
+   phdr->reserved = 0;
+
+   pcache->delta.tags[tag].count ++;
+   pcache->delta.tags[tag].allocs ++;
+   pcache->delta.tags[tag].bytes += size;
+   pcache->flush_bytes += size;
+   if (pcache->state != 1 || ++ pcache->ops >= DBX_MEM_FLUSH_OPS || pcache->flush_bytes >= DBX_MEM_FLUSH_BYTES) {
+      dbx_mem_flush(pcache);
+   }
+
+   return (void *) (phdr + 1);
 }
 
 
 int dbx_free(void *p, short id)
 {
+   int sclass, tag, idle_max;
+   DBXMEMHDR *phdr;
+   DBXMEMCACHE *pcache, cache;
+
    /* printf("\ndbx_free: id=%d; p=%p;", id, p); */
 
+   if (!p) {
+      return 0;
+   }
+
+   phdr = ((DBXMEMHDR *) p) - 1;
+   if (phdr->magic != DBX_MEM_MAGIC) {
+      /* not a block from dbx_malloc() or one already released: carrying on would corrupt the free-lists */
+      fprintf(stderr, "\r\nmg-dbx: dbx_free: invalid or repeated release of %p (id=%d)\r\n", p, (int) id);
+      abort();
+   }
+   phdr->magic = 0;
+   sclass = phdr->sclass;
+   tag = phdr->tag;
+
+   pcache = dbx_mem_cache();
+   if (!pcache) {
+      memset((void *) &cache, 0, sizeof(DBXMEMCACHE));
+      pcache = &cache;
+   }
+
+   pcache->delta.tags[tag].count --;
+   pcache->delta.tags[tag].bytes -= phdr->size;
+   pcache->flush_bytes += phdr->size;
+   if (pcache->state == 1 && sclass >= 0) {
+      idle_max = DBX_MEM_CLASS_IDLE_BYTES / dbx_mem_class_size[sclass];
+      if (idle_max > DBX_MEM_CLASS_IDLE_MAX) {
+         idle_max = DBX_MEM_CLASS_IDLE_MAX;
+      }
+      if (pcache->class_idle[sclass] < idle_max) {
+         *((void **) (phdr + 1)) = pcache->class_free[sclass];
+         pcache->class_free[sclass] = (void *) phdr;
+         pcache->class_idle[sclass] ++;
+         pcache->delta.class_idle_bytes += dbx_mem_class_size[sclass];
+         phdr = NULL;
+      }
+   }
+   if (pcache->state != 1 || ++ pcache->ops >= DBX_MEM_FLUSH_OPS || pcache->flush_bytes >= DBX_MEM_FLUSH_BYTES) {
+      dbx_mem_flush(pcache);
+   }
+
+   if (phdr) {
 #if defined(_WIN32)
-      HeapFree(GetProcessHeap(), 0, p);
+      HeapFree(GetProcessHeap(), 0, (void *) phdr);
 #else
-   free((void *) p);
+      free((void *) phdr);
+#endif
+   }
+
+   return 0;
+}
+
+
+/* v2.1.20 */
+int dbx_mem_class(int size)
+{
+   int sclass;
+
+   for (sclass = 0; sclass < DBX_MEM_CLASSES; sclass ++) {
+      if (size <= dbx_mem_class_size[sclass]) {
+         return sclass;
+      }
+   }
+   return -1;
+}
+
+
+#if !defined(_WIN32)
+static void dbx_mem_key_create(void)
+{
+   pthread_key_create(&dbx_mem_key, dbx_mem_thread_exit);
+}
+#endif
+
+
+/* v2.1.20 the calling thread's cache: NULL once it has been released as the thread exits */
+DBXMEMCACHE * dbx_mem_cache(void)
+{
+   DBXMEMCACHE *pcache;
+
+   pcache = &dbx_mem_cache_thread;
+   if (pcache->state == 1) {
+      return pcache;
+   }
+   if (pcache->state == 2) {
+      return NULL;
+   }
+
+#if !defined(_WIN32)
+   /* register the cache so that it is released when the thread exits (Windows: see DllMain) */
+   pthread_once(&dbx_mem_once, dbx_mem_key_create);
+   pthread_setspecific(dbx_mem_key, (void *) pcache);
+#endif
+   pcache->state = 1;
+
+   return pcache;
+}
+
+
+/* v2.1.20 add a thread's accounting to the process totals */
+int dbx_mem_flush(DBXMEMCACHE *pcache)
+{
+   int n;
+   long long bytes, peak;
+   DBXMEMSTATS *pdelta;
+
+   pdelta = &(pcache->delta);
+   if (pdelta->class_hits) {
+      DBX_ATOMIC_ADD(&dbx_mem_stats_global.class_hits, pdelta->class_hits);
+   }
+   if (pdelta->class_misses) {
+      DBX_ATOMIC_ADD(&dbx_mem_stats_global.class_misses, pdelta->class_misses);
+   }
+   if (pdelta->class_idle_bytes) {
+      DBX_ATOMIC_ADD(&dbx_mem_stats_global.class_idle_bytes, pdelta->class_idle_bytes);
+   }
+   for (n = 0; n < DBX_MEM_TAGS; n ++) {
+      if (!pdelta->tags[n].count && !pdelta->tags[n].allocs && !pdelta->tags[n].bytes) {
+         continue;
+      }
+      DBX_ATOMIC_ADD(&dbx_mem_stats_global.tags[n].count, pdelta->tags[n].count);
+      DBX_ATOMIC_ADD(&dbx_mem_stats_global.tags[n].allocs, pdelta->tags[n].allocs);
+      bytes = DBX_ATOMIC_ADD(&dbx_mem_stats_global.tags[n].bytes, pdelta->tags[n].bytes);
+      peak = DBX_ATOMIC_LOAD(&dbx_mem_stats_global.tags[n].bytes_peak);
+      while (bytes > peak && !DBX_ATOMIC_CAS(&dbx_mem_stats_global.tags[n].bytes_peak, peak, bytes)) {
+         peak = DBX_ATOMIC_LOAD(&dbx_mem_stats_global.tags[n].bytes_peak);
+      }
+   }
+
+   memset((void *) pdelta, 0, sizeof(DBXMEMSTATS));
+   pcache->ops = 0;
+   pcache->flush_bytes = 0;
+
+   return 0;
+}
+
+
+/* v2.1.20 release the blocks held by an exiting thread (NULL: the calling thread) */
+void dbx_mem_thread_exit(void *p)
+{
+   int sclass;
+   DBXMEMHDR *phdr;
+   DBXMEMCACHE *pcache;
+
+   pcache = p ? (DBXMEMCACHE *) p : &dbx_mem_cache_thread;
+   if (pcache->state != 1) {
+      return;
+   }
+   pcache->state = 2;
+
+   for (sclass = 0; sclass < DBX_MEM_CLASSES; sclass ++) {
+      while (pcache->class_free[sclass]) {
+         phdr = (DBXMEMHDR *) pcache->class_free[sclass];
+         pcache->class_free[sclass] = *((void **) (phdr + 1));
+         pcache->delta.class_idle_bytes -= dbx_mem_class_size[sclass];
+#if defined(_WIN32)
+         HeapFree(GetProcessHeap(), 0, (void *) phdr);
+#else
+         free((void *) phdr);
 #endif
+      }
+      pcache->class_idle[sclass] = 0;
+   }
+   dbx_mem_flush(pcache);
+
+   return;
+}
+
+
+/* v2.1.20 */
+int dbx_mem_tag_index(short id)
+{
+   int tag;
+
+   tag = (id / 100);
+   if (tag < 0 || tag >= DBX_MEM_TAGS) {
+      tag = 0;
+   }
+   return tag;
+}
+
+
+/* v2.1.20 */
+const char * dbx_mem_tag_name(int tag_index)
+{
+   if (tag_index < 0 || tag_index >= DBX_MEM_TAGS) {
+      return dbx_mem_tag_names[0];
+   }
+   return dbx_mem_tag_names[tag_index];
+}
+
+
+/* v2.1.20 */
+int dbx_mem_stats(DBXMEMSTATS *pstats)
+{
+   int n;
+   DBXMEMCACHE *pcache;
+
+   /* other threads' figures reach the totals in batches (see dbx_mem_flush) */
+   pcache = dbx_mem_cache();
+   if (pcache) {
+      dbx_mem_flush(pcache);
+   }
+
+   pstats->class_hits = DBX_ATOMIC_LOAD(&dbx_mem_stats_global.class_hits);
+   pstats->class_misses = DBX_ATOMIC_LOAD(&dbx_mem_stats_global.class_misses);
+   pstats->class_idle_bytes = DBX_ATOMIC_LOAD(&dbx_mem_stats_global.class_idle_bytes);
+   for (n = 0; n < DBX_MEM_TAGS; n ++) {
+      pstats->tags[n].count = DBX_ATOMIC_LOAD(&dbx_mem_stats_global.tags[n].count);
+      pstats->tags[n].allocs = DBX_ATOMIC_LOAD(&dbx_mem_stats_global.tags[n].allocs);
+      pstats->tags[n].bytes = DBX_ATOMIC_LOAD(&dbx_mem_stats_global.tags[n].bytes);
+      pstats->tags[n].bytes_peak = DBX_ATOMIC_LOAD(&dbx_mem_stats_global.tags[n].bytes_peak);
+   }
 
    return 0;
 }
 
+
+/* v2.1.20 the key arena and data buffer are allocated on first use (see dbx_qr_key_alloc and dbx_qr_data_reserve) */
 DBXQR * dbx_alloc_dbxqr(DBXQR *pqr, int dsize, short context)
 {
    int n;
-   char *p;
 
-   pqr = (DBXQR *) dbx_malloc(sizeof(DBXQR) + CACHE_MAXSTRLEN, 0);
+   pqr = (DBXQR *) dbx_malloc(sizeof(DBXQR) + 128, 501);
    if (!pqr) {
       return pqr;
    }
-   pqr->kbuffer_size = CACHE_MAXSTRLEN;
-   p = (char *) ((char *) pqr) + sizeof(DBXQR);
-   pqr->global_name.buf_addr = p;
+   pqr->global_name.buf_addr = ((char *) pqr) + sizeof(DBXQR);
    pqr->global_name.len_alloc = 128;
    pqr->global_name.len_used = 0;
-   p += 128;
-   pqr->kbuffer = (unsigned char *) p;
+   pqr->kbuffer = NULL;
+   pqr->kbuffer_size = 0;
+   pqr->kbuffer_used = 0;
+   pqr->keyn = 0;
    for (n = 0; n < DBX_MAXARGS; n ++) {
-      pqr->key[n].buf_addr = (p + 5);
-      pqr->key[n].len_alloc = 256;
+      pqr->key[n].buf_addr = NULL;
+      pqr->key[n].len_alloc = 0;
       pqr->key[n].len_used = 0;
-      p += (5 + 256);
    }
 
-   pqr->data.svalue.len_alloc = CACHE_MAXSTRLEN;
+   pqr->data.svalue.buf_addr = NULL;
+   pqr->data.svalue.len_alloc = 0;
    pqr->data.svalue.len_used = 0;
 
-   pqr->data.svalue.buf_addr = (char *) dbx_malloc(CACHE_MAXSTRLEN, 0);
-   if (pqr->data.svalue.buf_addr) {
-      pqr->data.svalue.len_alloc = CACHE_MAXSTRLEN;
-      pqr->data.svalue.len_used = 0;
-   }
    return pqr;
 }
 
 
 int dbx_free_dbxqr(DBXQR *pqr)
 {
+   if (!pqr) {
+      return 0;
+   }
    if (pqr->data.svalue.buf_addr) {
-      dbx_free((void *) pqr->data.svalue.buf_addr, 0); 
+      dbx_free((void *) pqr->data.svalue.buf_addr, 501); 
    }
-   dbx_free((void *) pqr, 0); 
+   if (pqr->kbuffer) {
+      dbx_free((void *) pqr->kbuffer, 501); 
+   }
+   dbx_free((void *) pqr, 501); 
    return 0;
 }
 
 
+/* v2.1.20 Make sure the key arena holds at least size bytes.  Keys already in the arena are carried across and rebased. */
+int dbx_qr_reserve(DBXQR *pqr, unsigned int size)
+{
+   int n;
+   unsigned int kbuffer_size;
+   unsigned char *kbuffer;
+
+   if (pqr->kbuffer && size <= pqr->kbuffer_size) {
+      return CACHE_SUCCESS;
+   }
+
+   kbuffer_size = pqr->kbuffer_size ? (pqr->kbuffer_size * 2) : DBX_QR_KEY_SLOT;
+   while (kbuffer_size < size) {
+      kbuffer_size *= 2;
+   }
+   kbuffer = (unsigned char *) dbx_malloc(kbuffer_size, 501);
+   if (!kbuffer) {
+      return CACHE_FAILURE;
+   }
+
+   if (pqr->kbuffer) {
+      if (pqr->kbuffer_used) {
+         memcpy((void *) kbuffer, (void *) pqr->kbuffer, (size_t) pqr->kbuffer_used);
+      }
+      for (n = 0; n < DBX_MAXARGS; n ++) {
+         if (pqr->key[n].buf_addr >= (char *) pqr->kbuffer && pqr->key[n].buf_addr < (char *) (pqr->kbuffer + pqr->kbuffer_size)) {
+            pqr->key[n].buf_addr = (char *) kbuffer + (pqr->key[n].buf_addr - (char *) pqr->kbuffer);
+         }
+      }
+      dbx_free((void *) pqr->kbuffer, 501);
+   }
+   pqr->kbuffer = kbuffer;
+   pqr->kbuffer_size = kbuffer_size;
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 Allocate len bytes (plus a null terminator) for key n immediately after key n-1 in the arena */
+char * dbx_qr_key_alloc(DBXQR *pqr, int n, unsigned int len)
+{
+   unsigned int offset;
+   char *p;
+
+   if (n < 0 || n >= DBX_MAXARGS) {
+      return NULL;
+   }
+
+   offset = 0;
+   if (n > 0 && pqr->key[n - 1].buf_addr) {
+      offset = (unsigned int) (pqr->key[n - 1].buf_addr - (char *) pqr->kbuffer) + pqr->key[n - 1].len_used + 1;
+   }
+   if (dbx_qr_reserve(pqr, offset + len + 1) != CACHE_SUCCESS) {
+      return NULL;
+   }
+
+   p = (char *) pqr->kbuffer + offset;
+   p[len] = '\0';
+   pqr->key[n].buf_addr = p;
+   pqr->key[n].len_alloc = len + 1;
+   pqr->key[n].len_used = len;
+   pqr->kbuffer_used = offset + len + 1;
+
+   return p;
+}
+
+
+int dbx_qr_key_set(DBXQR *pqr, int n, char *data, unsigned int len)
+{
+   char *p;
+
+   p = dbx_qr_key_alloc(pqr, n, len);
+   if (!p) {
+      return CACHE_FAILURE;
+   }
+   if (len) {
+      memcpy((void *) p, (void *) data, (size_t) len);
+   }
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 Make sure the data buffer holds at least size bytes.  The previous contents are not preserved. */
+int dbx_qr_data_reserve(DBXQR *pqr, unsigned int size)
+{
+   char *p;
+
+   if (pqr->data.svalue.buf_addr && size <= pqr->data.svalue.len_alloc) {
+      return CACHE_SUCCESS;
+   }
+   if (size < DBX_QR_DATA_MIN) {
+      size = DBX_QR_DATA_MIN;
+   }
+   p = (char *) dbx_malloc(size, 501);
+   if (!p) {
+      return CACHE_FAILURE;
+   }
+   if (pqr->data.svalue.buf_addr) {
+      dbx_free((void *) pqr->data.svalue.buf_addr, 501);
+   }
+   pqr->data.svalue.buf_addr = p;
+   pqr->data.svalue.len_alloc = size;
+   pqr->data.svalue.len_used = 0;
+
+   return CACHE_SUCCESS;
+}
+
+
 int dbx_ucase(char *string)
 {
 #ifdef _UNICODE
@@ -9402,6 +12509,10 @@ int dbx_error_message(DBXMETH *pmeth, int error_code)
       rc = isc_error_message(pcon, error_code);
    }
 
+   if (pcon->error[0]) { /* v2.1.20 */
+      dbx_request_error(pmeth);
+   }
+
    if (pcon->log_errors) {
       dbx_log_event(pcon, pcon->error, (char *) "mg-dbx: error", 0);
    }
@@ -9506,7 +12617,10 @@ int dbx_mutex_unlock(DBXMUTEX *p_mutex)
    }
 
    tid = dbx_current_thread_id();
-   if (p_mutex->thid == tid && p_mutex->stack) {
+   if (p_mutex->thid != tid) { /* v2.1.20 not held by this thread (a method's closing unlock after the database function has released it): leave another thread's lock alone */
+      return 0;
+   }
+   if (p_mutex->stack) {
       /* printf("\r\n thread has stacked locks : thid=%lu; stack=%d;\r\n", (unsigned long) tid, p_mutex->stack); */
       p_mutex->stack --;
       return 0;
@@ -33,7 +33,7 @@
 
 #define DBX_VERSION_MAJOR        "2"
 #define DBX_VERSION_MINOR        "1"
-#define DBX_VERSION_BUILD        "19"
+#define DBX_VERSION_BUILD        "20"
 
 #define DBX_VERSION              DBX_VERSION_MAJOR "." DBX_VERSION_MINOR "." DBX_VERSION_BUILD
 
@@ -117,7 +117,10 @@
 #include <errno.h>
 #include <unistd.h>
 #include <sys/time.h>
+#include <poll.h>
 #include <stdarg.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #endif
 
 #if defined(__GNUC__) && __GNUC__ >= 8
@@ -144,7 +147,15 @@ DISABLE_WCAST_FUNCTION_TYPE
 #define DBX_MAXARGS              64
 #define DBX_DEFAULT_TIMEOUT      30
 
-#define DBX_THREADPOOL_MAX       8
+#define DBX_THREADPOOL_MAX       64 /* v2.1.20 upper limit for the pool_size property */
+#define DBX_POOL_QUEUE_SIZE      1024 /* v2.1.20 capacity of a pool's task queue (a power of 2) */
+#define DBX_POOL_IDLE_CHECK_NS   1000000000ULL /* v2.1.20 a worker's connection idle for longer than this is checked before it is used */
+
+/* v2.1.20 scheduling lanes: long running requests are confined to a subset of a pool's threads */
+#define DBX_POOL_LANES           2
+#define DBX_LANE_DEFAULT         -1
+#define DBX_LANE_SHORT           0
+#define DBX_LANE_LONG            1
 
 #define DBX_ERROR_SIZE           512
 
@@ -152,6 +163,25 @@ DISABLE_WCAST_FUNCTION_TYPE
 
 #define DBX_TEXT_E_ASYNC         "Unable to process task asynchronously"
 
+/* v2.1.20 admission control for asynchronous requests (the overflow property) */
+#define DBX_OVERFLOW_REJECT      0
+#define DBX_OVERFLOW_BLOCK       1
+#define DBX_OVERFLOW_QUEUE       2
+
+#define DBX_TRANSPORT_THREADS    0 /* v2.1.20 asynchronous requests are run by a pool of threads */
+#define DBX_TRANSPORT_UV         1 /* v2.1.20 asynchronous requests are written and read by the event loop */
+#define DBX_ADMIT_QUEUE_MAX      1000
+
+#define DBX_TASK_NO_ADMISSION    1
+
+/* v2.1.20 coalescing of identical read requests in progress (the coalesce property) */
+#define DBX_COALESCE_HASH        64
+#define DBX_COALESCE_KEY_MAX     256
+
+#define DBX_ERROR_OVERLOAD       -1001
+#define DBX_TEXT_E_OVERLOAD      "Too many asynchronous requests in progress on this connection"
+#define DBX_CODE_E_OVERLOAD      "EDBXOVERLOAD"
+
 #define DBX_DSORT_INVALID        0
 #define DBX_DSORT_DATA           1
 #define DBX_DSORT_SUBSCRIPT      2
@@ -209,6 +239,55 @@ DISABLE_WCAST_FUNCTION_TYPE
 
 #define DBX_IBUFFER_OFFSET       15
 
+/* v2.1.20 */
+#define DBX_OBUFFER_SIZE         32000
+#define DBX_METH_POOL_MAX        16
+#define DBX_BATON_POOL_MAX       32
+#define DBX_ASYNC_DRAIN_MAX      256 /* v2.1.20 completions delivered per turn of the event loop */
+
+#if defined(_WIN32)
+#define DBX_THREAD_LOCAL         __declspec(thread)
+#else
+#define DBX_THREAD_LOCAL         __thread
+#endif
+#define DBX_METH_POOL_HWM        (CACHE_MAXSTRLEN * 4)
+#define DBX_ARGS_INLINE          8
+
+/* v2.1.20 network connections: Buffer arguments of DBX_IOV_MIN_SIZE bytes or more are sent from the caller's memory */
+#define DBX_IOV_MAX              4
+#define DBX_IOV_MIN_SIZE         65536
+#define DBX_IOV_ZEROCOPY_SIZE    262144 /* use MSG_ZEROCOPY (Linux) once a request carries this much */
+
+/* v2.1.20 argument slot N must be reserved before it is written */
+#define DBX_ARGS_RESERVE(PMETH, N)  ((N) < (PMETH)->args_max || dbx_request_args(PMETH, (N) + 1) == CACHE_SUCCESS)
+
+/* v2.1.20 size-class allocator behind dbx_malloc/dbx_free */
+#define DBX_MEM_MAGIC            0x6d676478
+#define DBX_MEM_CLASSES          13
+#define DBX_MEM_CLASS_MIN        32
+#define DBX_MEM_CLASS_MAX        65536
+#define DBX_MEM_CLASS_IBUFFER    ((CACHE_MAXSTRLEN + DBX_IBUFFER_OFFSET + 15) & ~15) /* the request block's input buffer */
+#define DBX_MEM_CLASS_IDLE_MAX   256
+#define DBX_MEM_CLASS_IDLE_BYTES 524288 /* per class and per thread */
+#define DBX_MEM_FLUSH_OPS        64     /* a thread's accounting is added to the process totals after this many calls ... */
+#define DBX_MEM_FLUSH_BYTES      65536  /* ... or once it has moved this many bytes */
+#define DBX_MEM_TAGS             10
+
+#if defined(_WIN32)
+#define DBX_ATOMIC_ADD(P, N)     (InterlockedExchangeAdd64((volatile LONG64 *) (P), (LONG64) (N)) + (N))
+#define DBX_ATOMIC_LOAD(P)       InterlockedCompareExchange64((volatile LONG64 *) (P), 0, 0)
+#define DBX_ATOMIC_CAS(P, O, N)  (InterlockedCompareExchange64((volatile LONG64 *) (P), (LONG64) (N), (LONG64) (O)) == (LONG64) (O))
+#else
+#define DBX_ATOMIC_ADD(P, N)     __atomic_add_fetch((P), (N), __ATOMIC_RELAXED)
+#define DBX_ATOMIC_LOAD(P)       __atomic_load_n((P), __ATOMIC_RELAXED)
+#define DBX_ATOMIC_CAS(P, O, N)  __atomic_compare_exchange_n((P), &(O), (N), 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#endif
+
+/* v2.1.20 cursor key arena */
+#define DBX_QR_KEY_SLOT          256
+#define DBX_QR_KEY_SLOT_MAX      1048576
+#define DBX_QR_DATA_MIN          256
+
 #if defined(MAX_PATH) && (MAX_PATH>511)
 #define DBX_MAX_PATH             MAX_PATH
 #else
@@ -298,6 +377,13 @@ DISABLE_WCAST_FUNCTION_TYPE
 #define DBX_ARRAY_NEW(a)            Array::New(isolate, a)
 
 #define DBX_NODE_SET_PROTOTYPE_METHOD(a, b, c)    NODE_SET_PROTOTYPE_METHOD(a, b, c);
+
+/* v2.1.20 register the Promise-returning variant (<name>Async) of an asynchronous method */
+#if DBX_NODE_VERSION >= 100000
+#define DBX_NODE_SET_PROTOTYPE_PROMISE(a, b, c)   dbx_set_prototype_promise(a, c, b);
+#else
+#define DBX_NODE_SET_PROTOTYPE_PROMISE(a, b, c)
+#endif
 /*
 #define DBX_NODE_SET_PROTOTYPE_METHOD(a, b, c)    dbx_set_prototype_method(a, c, b, b);
 */
@@ -396,6 +482,8 @@ DISABLE_WCAST_FUNCTION_TYPE
          return; \
       } \
    } \
+   PMETH->lane = C->lane_next; /* v2.1.20 */ \
+   C->lane_next = DBX_LANE_DEFAULT; \
 
 #else
 
@@ -412,6 +500,8 @@ DISABLE_WCAST_FUNCTION_TYPE
          return; \
       } \
    } \
+   PMETH->lane = C->lane_next; /* v2.1.20 */ \
+   C->lane_next = DBX_LANE_DEFAULT; \
 
 #endif
 
@@ -464,9 +554,13 @@ DISABLE_WCAST_FUNCTION_TYPE
 #define DBX_BOOLEAN_NEW(a)          Boolean::New(isolate, a)
 #define DBX_NULL()                  Null(isolate)
 
+/* v2.1.20 methods called through their Promise-returning variant are asynchronous with no callback argument */
 #define DBX_CALLBACK_FUN(JSNARG, CB, ASYNC) \
    JSNARG = args.Length(); \
-   if (JSNARG > 0 && args[JSNARG - 1]->IsFunction()) { \
+   if (dbx_promise_call) { \
+      ASYNC = 1; \
+   } \
+   else if (JSNARG > 0 && args[JSNARG - 1]->IsFunction()) { \
       ASYNC = 1; \
       JSNARG --; \
    } \
@@ -474,6 +568,27 @@ DISABLE_WCAST_FUNCTION_TYPE
       ASYNC = 0; \
    } \
 
+/* v2.1.20 attach the caller's callback, or a new Promise that is returned to the caller, to a baton */
+#if DBX_NODE_VERSION >= 100000
+#define DBX_BATON_CALLBACK(BATON, JSNARG) \
+   if (dbx_promise_call) { \
+      Local<Promise::Resolver> resolver = Promise::Resolver::New(isolate->GetCurrentContext()).ToLocalChecked(); \
+      BATON->resolver.Reset(isolate, resolver); \
+      BATON->promise = 1; \
+      args.GetReturnValue().Set(resolver->GetPromise()); \
+   } \
+   else { \
+      BATON->cb.Reset(isolate, Local<Function>::Cast(args[JSNARG])); \
+      BATON->promise = 0; \
+   } \
+
+#else
+#define DBX_BATON_CALLBACK(BATON, JSNARG) \
+   BATON->cb.Reset(isolate, Local<Function>::Cast(args[JSNARG])); \
+   BATON->promise = 0; \
+
+#endif
+
 #define DBX_DBFUN_END(C)
 
 #define DBX_DB_LOCK(RC, TIMEOUT) \
@@ -535,6 +650,10 @@ typedef struct tagDBXTID {
    int         thread_id;
    DBXMUTEX    *p_mutex;
    DBXZV       *p_zv;
+   void        *ppool;           /* v2.1.20 */
+   struct tagDBXCON *pcon;       /* v2.1.20 database context owned by this worker (network connections) */
+   short       connect;          /* v2.1.20 the worker makes its own connection when it starts */
+   unsigned long long used_ns;   /* v2.1.20 when the worker's connection was last used */
 } DBXTID, *PDBXTID;
 
 
@@ -648,6 +767,8 @@ typedef struct {
 #define YDB_LOCK_TIMEOUT   (YDB_INT_MAX - 4)
 #define YDB_NOTOK          (YDB_INT_MAX - 5)
 
+#define YDB_ERR_INVSTRLEN  -150375522
+
 typedef struct {
    unsigned int   len_alloc;
    unsigned int   len_used;
@@ -704,9 +825,25 @@ typedef struct tagDBXFUN {
 } DBXFUN, *PDBXFUN;
 
 
+/* v2.1.20 global name and fixed subscripts of an mglobal object, encoded once as they appear in the input buffer */
+typedef struct tagDBXGPFXARG {
+   short          type;
+   int            int32;
+   unsigned int   offset;
+   unsigned int   len;
+} DBXGPFXARG, *PDBXGPFXARG;
+
+typedef struct tagDBXGPFX {
+   int            argc;
+   unsigned int   ibuffer_used;
+   unsigned char  *ibuffer;
+   DBXGPFXARG     args[1];
+} DBXGPFX, *PDBXGPFX;
+
 typedef struct tagDBXGREF {
    char *         global;
    DBXVAL *       pkey;
+   DBXGPFX *      pprefix;       /* v2.1.20 */
 } DBXGREF, *PDBXGREF;
 
 typedef struct tagDBXFREF {
@@ -754,6 +891,7 @@ typedef struct tagDBXISCSO {
    short             multithread_enabled;
    int               no_connections;
    int               multiple_connections;
+   void              *ppool;           /* v2.1.20 thread pool shared by all connections to this API */
    char              funprfx[8];
    char              libdir[256];
    char              libnam[256];
@@ -837,6 +975,7 @@ typedef struct tagDBXYDBSO {
    short             loaded;
    int               no_connections;
    int               multiple_connections;
+   void              *ppool;           /* v2.1.20 thread pool shared by all connections to this API */
    char              libdir[256];
    char              libnam[256];
    char              funprfx[8];
@@ -880,6 +1019,7 @@ typedef struct tagDBXCON {
    int            error_code;
    char           error[DBX_ERROR_SIZE];
    DBXMUTEX       *p_mutex;
+   DBXMUTEX       mutex_net;  /* v2.1.20 network connections are serialized on their own socket */
    DBXZV          *p_zv;
 
    DBXISCSO       *p_isc_so;
@@ -892,6 +1032,9 @@ typedef struct tagDBXCON {
    int            timeout;
    int            eof;
    SOCKET         cli_socket;
+   unsigned char  *rbuf; /* v2.1.20 receive buffer (NETX_RECV_BUFFER bytes): rbuf_pos to rbuf_len not yet consumed */
+   int            rbuf_pos;
+   int            rbuf_len;
    char           info[256];
    DBXZV          zv;
 
@@ -899,6 +1042,45 @@ typedef struct tagDBXCON {
 
    void           *pmeth_base; /* v2.1.17 */
 
+   void           *pmeth_pool; /* v2.1.20 */
+   int            pmeth_pool_idle;
+   int            pmeth_pool_max;
+   unsigned long  pmeth_pool_hits;
+   unsigned long  pmeth_pool_misses;
+
+   void           *pasync; /* v2.1.20 */
+   void           *ppool; /* v2.1.20 */
+   int            pool_size;
+   int            pool_min; /* v2.1.20 threads started by open(): the others are started as the load requires */
+   int            long_threads; /* v2.1.20 */
+
+   int            max_inflight; /* v2.1.20 admission control */
+   int            max_queue;
+   short          overflow;
+   int            inflight;
+   int            admit_waiting;
+   unsigned long  admit_rejected;
+   unsigned long  admit_blocked;
+   unsigned long  admit_queued;
+
+   short          coalesce; /* v2.1.20 */
+   unsigned long  coalesced;
+
+   short          shared; /* v2.1.20 attach to the process-wide connection broker */
+   void           *pbroker;
+
+   short          pipeline; /* v2.1.20 ask the server for protocol revision 2 */
+   short          net_revision;
+   void           *ppipe;
+
+   short          transport; /* v2.1.20 DBX_TRANSPORT_THREADS or DBX_TRANSPORT_UV */
+   void           *puv;
+
+   short          zerocopy; /* v2.1.20 SO_ZEROCOPY on the socket: 0 not tried; 1 enabled; -1 not available */
+   unsigned int   zc_sent; /* MSG_ZEROCOPY sends made and completions collected: the kernel numbers them from zero */
+   unsigned int   zc_done;
+   unsigned long  zc_copied;
+
    int            log_errors;
    int            log_functions;
    int            log_transmissions;
@@ -908,25 +1090,78 @@ typedef struct tagDBXCON {
 } DBXCON, *PDBXCON;
 
 
+/* v2.1.20 process-wide connection broker: one network connection (and pool) shared by the connections of all isolates that ask for it */
+typedef struct tagDBXBROKER {
+   char           key[512];
+   int            refs;
+   DBXCON         *pcon;
+   struct tagDBXBROKER *pnext;
+} DBXBROKER, *PDBXBROKER;
+
+
+/* v2.1.20 the queue node is embedded in the request block (DBXMETH) */
+struct dbx_pool_task {
+#if !defined(_WIN32)
+   pthread_t   parent_tid;
+#endif
+   int         task_id;
+   struct tagDBXMETH *pmeth;
+   struct dbx_pool_task *next;
+   void        *pasync;          /* v2.1.20 completion channel (DBXASYNC) */
+   void        *req;
+   void        *after_work_cb;
+   unsigned long long enqueue_ns;
+   short       lane;             /* v2.1.20 */
+};
+
+
 /* v2.1.17 */
+/* v2.1.20 fields used on every call are kept together in the first cache line */
+/* v2.1.20 part of a request sent straight from a Buffer: it goes on the wire ahead of ibuffer[offset] */
+typedef struct tagDBXIOV {
+   unsigned int   offset;
+   unsigned int   len;
+   char           *data;
+   void           *pref;            /* v8::Persistent holding the Buffer until the request is released */
+} DBXIOV, *PDBXIOV;
+
+
 typedef struct tagDBXMETH {
-   short          done;
-   short          lock;
-   short          increment;
-   int            binary;
    int            argc;
    int            cargc;
-   unsigned int   ibuffer_size;
    unsigned int   ibuffer_used;
+   unsigned int   ibuffer_size;
    unsigned char *ibuffer;
-   DBXVAL         args[DBX_MAXARGS];
-   ydb_buffer_t   yargs[DBX_MAXARGS];
-   DBXVAL         output_val;
-   DBXSQL         *psql;
    int            (* p_dbxfun) (struct tagDBXMETH * pmeth);
    DBXCON         *pcon;
+   DBXVAL         *args;
+   ydb_buffer_t   *yargs;
+   short          done;
+   short          lock;
+   short          increment;
+   short          args_max;
+   int            binary;
+   int            args_exstr;
+   DBXVAL         output_val;
+   DBXSQL         *psql;
+   struct tagDBXMETH *pnext;
+   void           *args_ext;
+   void           *pwait;           /* v2.1.20 DBXWAIT of a thread blocked in dbx_pool_submit_task() */
+   struct dbx_pool_task task;       /* v2.1.20 */
+   void           *pcursor;         /* v2.1.20 mcursor read ahead by dbx_cursor_fetch() */
+   short          lane;             /* v2.1.20 DBX_LANE_DEFAULT: chosen by the type of request */
+   int            net_command;      /* v2.1.20 command to be sent by a thread of the connection broker */
+   int            net_context;
+   int            net_rc;
+   unsigned int   net_id;           /* v2.1.20 request ID and bytes written by the event-loop transport */
+   unsigned int   net_sent;
+   int            iov_n;            /* v2.1.20 */
+   unsigned int   iov_len;
+   DBXIOV         iov[DBX_IOV_MAX];
    int            error_code;
    char           error[DBX_ERROR_SIZE];
+   DBXVAL         args_inline[DBX_ARGS_INLINE];
+   ydb_buffer_t   yargs_inline[DBX_ARGS_INLINE];
 } DBXMETH, *PDBXMETH;
 
 
@@ -934,21 +1169,111 @@ typedef struct tagDBXQR {
    ydb_buffer_t   global_name;
    unsigned int   kbuffer_size;
    unsigned int   kbuffer_used;
-   unsigned char *kbuffer;
+   unsigned char *kbuffer;          /* v2.1.20 key arena: allocated on first use and grown on demand */
    int            keyn;
    ydb_buffer_t   key[DBX_MAXARGS];
    DBXVAL         data;
 } DBXQR, *PDBXQR;
 
 
-struct dbx_pool_task {
+/* v2.1.20 */
+typedef struct tagDBXMEMHDR {
+   unsigned int   magic;
+   short          sclass;
+   short          tag;
+   unsigned int   size;
+   unsigned int   reserved;
+} DBXMEMHDR, *PDBXMEMHDR;
+
+typedef struct tagDBXMEMTAG {
+   long long      count;
+   long long      allocs;
+   long long      bytes;
+   long long      bytes_peak;
+} DBXMEMTAG, *PDBXMEMTAG;
+
+typedef struct tagDBXMEMSTATS {
+   long long      class_hits;
+   long long      class_misses;
+   long long      class_idle_bytes;
+   DBXMEMTAG      tags[DBX_MEM_TAGS];
+} DBXMEMSTATS, *PDBXMEMSTATS;
+
+/* v2.1.20 each thread keeps its own free-lists and gathers its accounting before adding it to the process totals */
+typedef struct tagDBXMEMCACHE {
+   short          state;            /* 0: not yet used; 1: in use; 2: released as the thread exits */
+   int            ops;
+   long long      flush_bytes;
+   void *         class_free[DBX_MEM_CLASSES];
+   int            class_idle[DBX_MEM_CLASSES];
+   DBXMEMSTATS    delta;
+} DBXMEMCACHE, *PDBXMEMCACHE;
+
+
+/* v2.1.20 Database thread pool: created once per API or per network connection */
 #if !defined(_WIN32)
-   pthread_t   parent_tid;
+typedef struct tagDBXPOOLCELL {
+   unsigned long     sequence;
+   struct dbx_pool_task *task;
+} DBXPOOLCELL, *PDBXPOOLCELL;
+
+/* v2.1.20 bounded lock-free queue: one per scheduling lane */
+typedef struct tagDBXPOOLLANE {
+   DBXPOOLCELL       *queue;
+   unsigned long     queue_mask;
+   unsigned long     enqueue_pos;
+   unsigned long     dequeue_pos;
+   unsigned long     depth_peak;
+   unsigned long long tasks;
+   unsigned long long wait_ns_total;
+   unsigned long long wait_ns_max;
+} DBXPOOLLANE, *PDBXPOOLLANE;
+
+/* v2.1.20 the mutex is only taken to put idle workers to sleep and wake them */
+typedef struct tagDBXPOOL {
+   DBXPOOLLANE       lane[DBX_POOL_LANES];
+   int               long_max;         /* threads that may work on the long lane at any one time */
+   int               long_active;
+   int               idle;
+   short             stop;
+   int               size;
+   int               size_max;         /* threads are added on demand up to this number */
+   int               starting;         /* threads still connecting to the server */
+   short             grow_failed;
+   unsigned long long reconnects;
+   struct tagDBXCON  *ptemplate;       /* connection parameters for threads started later */
+   pthread_mutex_t   mutex;
+   pthread_cond_t    cond;
+   pthread_cond_t    room;             /* signalled when a task leaves a full queue and a submitter is waiting */
+   int               room_waiting;
+   DBXTID            *ptid;
+   pthread_t         *pthreads;
+} DBXPOOL, *PDBXPOOL;
+#endif
+
+
+/* v2.1.20 Completion signal private to one request so that only its own submitter is woken */
+#if !defined(_WIN32)
+typedef struct tagDBXWAIT {
+   pthread_mutex_t   mutex;
+   pthread_cond_t    cond;
+   short             done;
+} DBXWAIT, *PDBXWAIT;
+#endif
+
+
+/* v2.1.20 Requests completed by the thread pool are handed straight back to the event loop through a uv_async_t */
+#if !defined(_WIN32)
+typedef struct tagDBXASYNC {
+   uv_async_t        async;
+   pthread_mutex_t   mutex;
+   struct dbx_pool_task *phead;
+   struct dbx_pool_task *ptail;
+   int               pending;
+   short             closing;          /* 1: close when drained, 2: uv_close() issued */
+   pthread_cond_t    admit_cond;       /* signalled when a request leaves a DB thread and a submitter is blocked */
+} DBXASYNC, *PDBXASYNC;
 #endif
-   int         task_id;
-   DBXMETH     *pmeth;
-   struct dbx_pool_task *next;
-};
 
 
 class DBX_DBNAME : public node::ObjectWrap
@@ -984,8 +1309,35 @@ public:
       v8::Isolate *                 isolate;
       DBXCON *                      pcon;
       DBXMETH *                     pmeth;
+      short                         promise;    /* v2.1.20 */
+      v8::Persistent<v8::Promise::Resolver> resolver;
+      uv_work_t                     work;
+      void *                        after_work_cb;
+      struct dbx_baton_t *          pnext;
+      short                         coalesce;   /* v2.1.20 0: not coalesced, 1: accepting followers, 2: no longer accepting followers */
+      unsigned int                  coalesce_hash;
+      unsigned int                  coalesce_len;
+      void *                        coalesce_fun;
+      unsigned char                 coalesce_key[DBX_COALESCE_KEY_MAX];
+      struct dbx_baton_t *          pchain;
+      struct dbx_baton_t *          pfollow_head;
+      struct dbx_baton_t *          pfollow_tail;
    };
 
+   dbx_baton_t *  baton_pool; /* v2.1.20 */
+   int            baton_pool_idle;
+
+   dbx_baton_t *  admit_head; /* v2.1.20 requests held back by admission control */
+   dbx_baton_t *  admit_tail;
+   int            admit_held;
+   short          saturated;
+   short          saturated_reported;
+   v8::Persistent<v8::Function> saturation_cb;
+
+   short          lane_next; /* v2.1.20 lane for the next request, set by lane() */
+
+   dbx_baton_t *  coalesce_table[DBX_COALESCE_HASH]; /* v2.1.20 read requests in progress that identical requests may attach to */
+
 #if DBX_NODE_VERSION >= 100000
    static void                   Init                             (v8::Local<v8::Object> exports);
 #else
@@ -998,6 +1350,15 @@ public:
 
    static dbx_baton_t *          dbx_make_baton                   (DBX_DBNAME *c, DBXMETH *pmeth);
    static int                    dbx_destroy_baton                (dbx_baton_t *baton, DBXMETH *pmeth);
+   static void                   dbx_complete_baton               (dbx_baton_t *baton, v8::Local<v8::Value> argv[2], char *error = NULL);
+   static int                    dbx_admit                        (dbx_baton_t *baton, void *after_work_cb);
+   static int                    dbx_admit_drain                  (DBX_DBNAME *c);
+   static int                    dbx_admit_flush                  (DBX_DBNAME *c);
+   static void                   dbx_saturation_callback          (DBX_DBNAME *c, v8::Local<v8::Value> argv[1]);
+   static int                    dbx_coalesce                     (dbx_baton_t *baton);
+   static void                   dbx_coalesce_unlink              (dbx_baton_t *baton);
+   static void                   dbx_coalesce_reset               (DBX_DBNAME *c);
+   static void                   dbx_coalesce_complete            (dbx_baton_t *baton, v8::Local<v8::Value> argv[2]);
 
    static int                    dbx_queue_task                   (void * work_cb, void * after_work_cb, dbx_baton_t *baton, short context);
    static async_rtn              dbx_process_task                 (uv_work_t *req);
@@ -1045,6 +1406,10 @@ public:
    static void                   SQL_Close                        (const v8::FunctionCallbackInfo<v8::Value>& args);
 
    static void                   Benchmark                        (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   MemStats                         (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   PoolStats                        (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Lane                             (const v8::FunctionCallbackInfo<v8::Value>& args);
+   static void                   Saturation                       (const v8::FunctionCallbackInfo<v8::Value>& args);
 
 private:
 
@@ -1055,22 +1420,39 @@ private:
 DBXMETH *                  dbx_request_memory         (DBXCON *pcon, short context);
 DBXMETH *                  dbx_request_memory_alloc   (DBXCON *pcon, short context);
 int                        dbx_request_memory_free    (DBXCON *pcon, DBXMETH *pmeth, short context);
+int                        dbx_request_memory_shrink  (DBXMETH *pmeth);
+int                        dbx_request_args           (DBXMETH *pmeth, int argc);
+int                        dbx_output_buffer_size     (DBXMETH *pmeth, unsigned int size);
+int                        dbx_request_memory_release (DBXMETH *pmeth);
+int                        dbx_request_memory_pool_free (DBXCON *pcon);
 
 #if DBX_NODE_VERSION >= 100000
 void                       dbx_set_prototype_method   (v8::Local<v8::FunctionTemplate> t, v8::FunctionCallback callback, const char* name, const char* data);
+void                       dbx_set_prototype_promise  (v8::Local<v8::FunctionTemplate> t, v8::FunctionCallback callback, const char* name);
+void                       dbx_promise_method         (const v8::FunctionCallbackInfo<v8::Value>& args);
 #else
 void                       dbx_set_prototype_method   (v8::Handle<v8::FunctionTemplate> t, v8::FunctionCallback callback, const char* name, const char* data);
 #endif
 
+extern DBX_THREAD_LOCAL short dbx_promise_call; /* v2.1.20 set while a Promise-returning variant is being called */
+
 v8::Local<v8::Object>      dbx_is_object              (v8::Local<v8::Value> value, int *otype);
 int                        dbx_string8_length         (v8::Isolate * isolate, v8::Local<v8::String> str, int utf8);
 v8::Local<v8::String>      dbx_new_string8            (v8::Isolate * isolate, char * buffer, int utf8);
 v8::Local<v8::String>      dbx_new_string8n           (v8::Isolate * isolate, char * buffer, unsigned long len, int utf8);
+v8::Local<v8::Object>      dbx_new_buffer             (v8::Isolate * isolate, DBXMETH *pmeth);
 int                        dbx_write_char8            (v8::Isolate * isolate, v8::Local<v8::String> str, char * buffer, int utf8);
 
 int                        dbx_ibuffer_add            (DBXMETH *pmeth, v8::Isolate * isolate, int argn, v8::Local<v8::String> str, char * buffer, int buffer_len, short context);
+int                        dbx_ibuffer_add_int        (DBXMETH *pmeth, int argn, long long num, short type);
+int                        dbx_ibuffer_add_buffer     (DBXMETH *pmeth, v8::Isolate * isolate, int argn, v8::Local<v8::Object> obj, short context);
+int                        dbx_ibuffer_release        (DBXMETH *pmeth);
+int                        dbx_int64_to_str           (char *buffer, long long num);
+int                        dbx_is_integer             (double num, long long *pint64);
 int                        dbx_cursor_init            (void *pcx);
 int                        dbx_global_reset           (const v8::FunctionCallbackInfo<v8::Value>& args, v8::Isolate * isolate, DBXCON *pcon, DBXMETH *pmeth, void *pgx, int argc_offset, short context);
+DBXGPFX *                  dbx_global_prefix          (DBXMETH *pmeth, char *global, DBXVAL *pkey);
+int                        dbx_global_prefix_add      (DBXMETH *pmeth, DBXGPFX *pprefix);
 int                        dbx_cursor_reset           (const v8::FunctionCallbackInfo<v8::Value>& args, v8::Isolate * isolate, DBXCON *pcon, DBXMETH *pmeth, void *pcx, int argc_offset, short context);
 
 int                        isc_load_library           (DBXCON *pcon);
@@ -1128,6 +1510,9 @@ int                        dbx_sql_cleanup            (DBXMETH *pmeth);
 int                        dbx_global_directory       (DBXMETH *pmeth, DBXQR *pqr_prev, short dir, int *counter);
 int                        dbx_global_order           (DBXMETH *pmeth, DBXQR *pqr_prev, short dir, short getdata);
 int                        dbx_global_query           (DBXMETH *pmeth, DBXQR *pqr_next, DBXQR *pqr_prev, short dir, short getdata);
+int                        dbx_cursor_fetch           (DBXMETH *pmeth);
+int                        dbx_cursor_add_field       (DBXSTR *prec, char *data, int len);
+void                       dbx_throw_queue_error      (v8::Isolate * isolate, DBXCON *pcon, char *error);
 int                        dbx_parse_global_reference (DBXMETH *pmeth, DBXQR *pqr, char *global_ref, int global_ref_len);
 
 int                        dbx_launch_thread          (DBXMETH *pmeth);
@@ -1137,12 +1522,43 @@ LPTHREAD_START_ROUTINE     dbx_thread_main            (LPVOID pargs);
 void *                     dbx_thread_main            (void *pargs);
 #endif
 
-struct dbx_pool_task *     dbx_pool_add_task          (DBXMETH *pmeth);
-struct dbx_pool_task *     dbx_pool_get_task          (void);
-void                       dbx_pool_execute_task      (struct dbx_pool_task *task, int thread_id);
+int                        dbx_request_run            (DBXMETH *pmeth);
+int                        dbx_request_error          (DBXMETH *pmeth);
+struct dbx_pool_task *     dbx_pool_add_task          (DBXMETH *pmeth, void *pasync, void *req, void *after_work_cb, int wait);
+void                       dbx_pool_execute_task      (struct dbx_pool_task *task, DBXTID *ptid);
 void *                     dbx_pool_requests_loop     (void *data);
-int                        dbx_pool_thread_init       (DBXCON *pcon, int num_threads);
 int                        dbx_pool_submit_task       (DBXMETH *pmeth);
+#if !defined(_WIN32)
+short                      dbx_pool_lane              (DBXMETH *pmeth);
+struct dbx_pool_task *     dbx_pool_get_task          (DBXPOOL *ppool);
+struct dbx_pool_task *     dbx_pool_long_get_task     (DBXPOOL *ppool);
+int                        dbx_pool_room              (DBXPOOL *ppool);
+struct dbx_pool_task *     dbx_pool_lane_get_task     (DBXPOOLLANE *plane);
+int                        dbx_pool_put_task          (DBXPOOL *ppool, struct dbx_pool_task *task);
+void                       dbx_pool_run_task          (DBXPOOL *ppool, struct dbx_pool_task *task, DBXTID *ptid);
+unsigned long long         dbx_clock_ns               (void);
+DBXPOOL *                  dbx_pool_create            (DBXCON *pcon, int size, short own_context);
+int                        dbx_pool_start_thread      (DBXPOOL *ppool, DBXCON *pcon, short own_context);
+int                        dbx_pool_grow              (DBXPOOL *ppool);
+int                        dbx_pool_shutdown          (DBXPOOL *ppool);
+DBXCON *                   dbx_pool_context_open      (DBXCON *pcon);
+int                        dbx_pool_context_reconnect (DBXCON *pcon_worker);
+int                        dbx_pool_context_check     (DBXTID *ptid);
+int                        dbx_broker_attach          (DBXCON *pcon);
+int                        dbx_broker_detach          (DBXCON *pcon);
+int                        dbx_broker_command         (DBXMETH *pmeth, int command, int context);
+int                        dbx_broker_execute         (DBXMETH *pmeth);
+int                        dbx_pool_context_close     (DBXCON *pcon_worker);
+int                        dbx_uv_open                (DBXCON *pcon, v8::Isolate *isolate);
+int                        dbx_net_command            (DBXMETH *pmeth);
+DBXASYNC *                 dbx_async_open             (DBXCON *pcon, uv_loop_t *loop);
+int                        dbx_async_submit           (DBXASYNC *pasync, DBXMETH *pmeth, void *req, void *after_work_cb);
+void                       dbx_async_complete         (struct dbx_pool_task *task);
+void                       dbx_async_release          (struct dbx_pool_task *task);
+void                       dbx_async_drain            (uv_async_t *handle);
+void                       dbx_async_close_callback   (uv_handle_t *handle);
+int                        dbx_async_close            (DBXCON *pcon);
+#endif
 int                        dbx_add_block_size         (unsigned char *block, unsigned long offset, unsigned long data_len, int dsort, int dtype);
 unsigned long              dbx_get_block_size         (unsigned char *block, unsigned long offset, int *dsort, int *dtype);
 int                        dbx_set_size               (unsigned char *str, unsigned long data_len);
@@ -1150,8 +1566,19 @@ unsigned long              dbx_get_size               (unsigned char *str);
 void *                     dbx_realloc                (void *p, int curr_size, int new_size, short id);
 void *                     dbx_malloc                 (int size, short id);
 int                        dbx_free                   (void *p, short id);
+int                        dbx_mem_class              (int size);
+DBXMEMCACHE *              dbx_mem_cache              (void);
+int                        dbx_mem_flush              (DBXMEMCACHE *pcache);
+void                       dbx_mem_thread_exit        (void *pcache);
+int                        dbx_mem_tag_index          (short id);
+const char *               dbx_mem_tag_name           (int tag_index);
+int                        dbx_mem_stats              (DBXMEMSTATS *pstats);
 DBXQR *                    dbx_alloc_dbxqr            (DBXQR *pqr, int dsize, short context);
 int                        dbx_free_dbxqr             (DBXQR *pqr);
+int                        dbx_qr_reserve             (DBXQR *pqr, unsigned int size);
+char *                     dbx_qr_key_alloc           (DBXQR *pqr, int n, unsigned int len);
+int                        dbx_qr_key_set             (DBXQR *pqr, int n, char *data, unsigned int len);
+int                        dbx_qr_data_reserve        (DBXQR *pqr, unsigned int size);
 int                        dbx_ucase                  (char *string);
 int                        dbx_lcase                  (char *string);
 
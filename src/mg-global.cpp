@@ -34,6 +34,9 @@ Persistent<Function> mglobal::constructor;
 
 mglobal::mglobal(int value) : dbx_count(value)
 {
+   pkey = NULL; /* v2.1.20 */
+   key_count = 0;
+   pprefix = NULL;
 }
 
 
@@ -86,6 +89,19 @@ void mglobal::Init(Handle<Object> exports)
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "reset", Reset);
    DBX_NODE_SET_PROTOTYPE_METHOD(tpl, "_close", Close);
 
+   /* v2.1.20 Promise-returning variants of the asynchronous methods */
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "get", Get);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "get_bx", Get_bx);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "set", Set);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "defined", Defined);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "delete", Delete);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "next", Next);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "previous", Previous);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "increment", Increment);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "lock", Lock);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "unlock", Unlock);
+   DBX_NODE_SET_PROTOTYPE_PROMISE(tpl, "merge", Merge);
+
 #if DBX_NODE_VERSION >= 120000
 /*
    mglobal_data->SetInternalField(0, constructor);
@@ -143,6 +159,7 @@ void mglobal::New(const FunctionCallbackInfo<Value>& args)
          pmeth->argc = argc;
          obj->c = c;
          obj->pkey = NULL;
+         obj->pprefix = NULL;
          obj->global_name[0] = '\0';
          rc = dbx_global_reset(args, isolate, pcon, pmeth, (void *) obj, 1, 1);
          if (rc < 0) {
@@ -205,8 +222,24 @@ int mglobal::async_callback(mglobal *gx)
 }
 
 
+/* v2.1.20 release the fixed subscripts and their pre-encoded form */
 int mglobal::delete_mglobal_template(mglobal *gx)
 {
+   DBXVAL *pval, *pvalp;
+
+   pval = gx->pkey;
+   while (pval) {
+      pvalp = pval;
+      pval = pval->pnext;
+      dbx_free((void *) pvalp, 401);
+   }
+   gx->pkey = NULL;
+   gx->key_count = 0;
+   if (gx->pprefix) {
+      dbx_free((void *) gx->pprefix, 401);
+      gx->pprefix = NULL;
+   }
+
    return 0;
 }
 
@@ -246,10 +279,11 @@ void mglobal::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
    pmeth->binary = binary;
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pprefix = gx->pprefix;
 
    DBX_CALLBACK_FUN(pmeth->argc, cb, async);
 
-   if (pmeth->argc >= DBX_MAXARGS) {
+   if ((pmeth->argc + gx->key_count) >= DBX_MAXARGS) { /* v2.1.20 the fixed subscripts use argument slots too */
       isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Get", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
@@ -268,14 +302,13 @@ void mglobal::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_get;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -307,7 +340,7 @@ void mglobal::GetEx(const FunctionCallbackInfo<Value>& args, int binary)
    DBX_DB_UNLOCK(rc);
    
    if (binary) {
-      Local<Object> bx = node::Buffer::New(isolate, (char *) pmeth->output_val.svalue.buf_addr, (size_t) pmeth->output_val.svalue.len_used).ToLocalChecked();
+      Local<Object> bx = dbx_new_buffer(isolate, pmeth);
       args.GetReturnValue().Set(bx);
    }
    else {
@@ -341,10 +374,11 @@ void mglobal::Set(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pprefix = gx->pprefix;
 
    DBX_CALLBACK_FUN(pmeth->argc, cb, async);
 
-   if (pmeth->argc >= DBX_MAXARGS) {
+   if ((pmeth->argc + gx->key_count) >= DBX_MAXARGS) { /* v2.1.20 the fixed subscripts use argument slots too */
       isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Set", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
@@ -363,14 +397,13 @@ void mglobal::Set(const FunctionCallbackInfo<Value>& args)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_set;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -429,10 +462,11 @@ void mglobal::Defined(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pprefix = gx->pprefix;
 
    DBX_CALLBACK_FUN(pmeth->argc, cb, async);
 
-   if (pmeth->argc >= DBX_MAXARGS) {
+   if ((pmeth->argc + gx->key_count) >= DBX_MAXARGS) { /* v2.1.20 the fixed subscripts use argument slots too */
       isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Defined", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
@@ -451,16 +485,15 @@ void mglobal::Defined(const FunctionCallbackInfo<Value>& args)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_defined;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
-         return;
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
+         return;
       }
       return;
    }
@@ -516,10 +549,11 @@ void mglobal::Delete(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pprefix = gx->pprefix;
 
    DBX_CALLBACK_FUN(pmeth->argc, cb, async);
 
-   if (pmeth->argc >= DBX_MAXARGS) {
+   if ((pmeth->argc + gx->key_count) >= DBX_MAXARGS) { /* v2.1.20 the fixed subscripts use argument slots too */
       isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Delete", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
@@ -538,14 +572,13 @@ void mglobal::Delete(const FunctionCallbackInfo<Value>& args)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_delete;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -603,10 +636,11 @@ void mglobal::Next(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pprefix = gx->pprefix;
 
    DBX_CALLBACK_FUN(pmeth->argc, cb, async);
 
-   if (pmeth->argc >= DBX_MAXARGS) {
+   if ((pmeth->argc + gx->key_count) >= DBX_MAXARGS) { /* v2.1.20 the fixed subscripts use argument slots too */
       isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Next", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
@@ -625,14 +659,13 @@ void mglobal::Next(const FunctionCallbackInfo<Value>& args)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_next;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -688,10 +721,11 @@ void mglobal::Previous(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pprefix = gx->pprefix;
 
    DBX_CALLBACK_FUN(pmeth->argc, cb, async);
 
-   if (pmeth->argc >= DBX_MAXARGS) {
+   if ((pmeth->argc + gx->key_count) >= DBX_MAXARGS) { /* v2.1.20 the fixed subscripts use argument slots too */
       isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Previous", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
@@ -710,14 +744,13 @@ void mglobal::Previous(const FunctionCallbackInfo<Value>& args)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_previous;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -774,10 +807,11 @@ void mglobal::Increment(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pprefix = gx->pprefix;
 
    DBX_CALLBACK_FUN(pmeth->argc, cb, async);
 
-   if (pmeth->argc >= DBX_MAXARGS) {
+   if ((pmeth->argc + gx->key_count) >= DBX_MAXARGS) { /* v2.1.20 the fixed subscripts use argument slots too */
       isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Increment", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
@@ -797,14 +831,13 @@ void mglobal::Increment(const FunctionCallbackInfo<Value>& args)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_increment;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -862,10 +895,11 @@ void mglobal::Lock(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pprefix = gx->pprefix;
 
    DBX_CALLBACK_FUN(pmeth->argc, cb, async);
 
-   if (pmeth->argc >= DBX_MAXARGS) {
+   if ((pmeth->argc + gx->key_count) >= DBX_MAXARGS) { /* v2.1.20 the fixed subscripts use argument slots too */
       isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Lock", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
@@ -890,14 +924,13 @@ void mglobal::Lock(const FunctionCallbackInfo<Value>& args)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_lock;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -980,10 +1013,11 @@ void mglobal::Unlock(const FunctionCallbackInfo<Value>& args)
 
    gref.global = gx->global_name;
    gref.pkey = gx->pkey;
+   gref.pprefix = gx->pprefix;
 
    DBX_CALLBACK_FUN(pmeth->argc, cb, async);
 
-   if (pmeth->argc >= DBX_MAXARGS) {
+   if ((pmeth->argc + gx->key_count) >= DBX_MAXARGS) { /* v2.1.20 the fixed subscripts use argument slots too */
       isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Too many arguments on Unlock", 1)));
       dbx_request_memory_free(pcon, pmeth, 0);
       return;
@@ -1003,14 +1037,13 @@ void mglobal::Unlock(const FunctionCallbackInfo<Value>& args)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_unlock;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -1086,6 +1119,12 @@ void mglobal::Merge(const FunctionCallbackInfo<Value>& args)
       return;
    }
 
+   if (dbx_request_args(pmeth, DBX_MAXARGS) != CACHE_SUCCESS) { /* v2.1.20 */
+      isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, (char *) "Unable to allocate memory for the Merge arguments", 1)));
+      dbx_request_memory_free(pcon, pmeth, 0);
+      return;
+   }
+
    nx = 0;
    mglobal1 = 0;
    pmeth->args[nx].type = DBX_DTYPE_STR;
@@ -1191,14 +1230,13 @@ void mglobal::Merge(const FunctionCallbackInfo<Value>& args)
       baton->gx = (void *) gx;
       baton->isolate = isolate;
       baton->pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) dbx_merge;
-      Local<Function> cb = Local<Function>::Cast(args[pmeth->argc]);
-      baton->cb.Reset(isolate, cb);
+      DBX_BATON_CALLBACK(baton, pmeth->argc); /* v2.1.20 */
       gx->Ref();
       if (c->dbx_queue_task((void *) c->dbx_process_task, (void *) c->dbx_invoke_callback, baton, 0)) {
          char error[DBX_ERROR_SIZE];
          T_STRCPY(error, _dbxso(error), pcon->error);
          c->dbx_destroy_baton(baton, pmeth);
-         isolate->ThrowException(Exception::Error(dbx_new_string8(isolate, error, 1)));
+         dbx_throw_queue_error(isolate, pcon, error); /* v2.1.20 */
          dbx_request_memory_free(pcon, pmeth, 0);
          return;
       }
@@ -1265,7 +1303,6 @@ void mglobal::Close(const FunctionCallbackInfo<Value>& args)
 {
    DBXCON *pcon;
    DBXMETH *pmeth;
-   DBXVAL *pval, *pvalp;
    mglobal *gx = ObjectWrap::Unwrap<mglobal>(args.This());
    MG_GLOBAL_CHECK_CLASS(gx);
    DBX_DBNAME *c = gx->c;
@@ -1291,16 +1328,8 @@ void mglobal::Close(const FunctionCallbackInfo<Value>& args)
       return;
    }
 
-   pval = gx->pkey;
-   while (pval) {
-      pvalp = pval;
-      pval = pval->pnext;
-      dbx_free((void *) pvalp, 0);
-   }
-   gx->pkey = NULL;
-/*
-   cx->delete_mglobal_template(gx);
-*/
+   gx->delete_mglobal_template(gx); /* v2.1.20 */
+
    dbx_request_memory_free(pcon, pmeth, 0);
    return;
 }
@@ -1308,6 +1337,31 @@ void mglobal::Close(const FunctionCallbackInfo<Value>& args)
 int dbx_escape_output(DBXSTR *pdata, char *item, int item_len, short context)
 {
    int n;
+   unsigned int size;
+   char *p;
+
+   /* v2.1.20 the output buffer is allocated on first use and grown on demand */
+   size = pdata->len_used + (item_len * 3) + 1;
+   if (!pdata->buf_addr || size > pdata->len_alloc) {
+      if (size < 256) {
+         size = 256;
+      }
+      if (size < (pdata->len_alloc * 2)) {
+         size = pdata->len_alloc * 2;
+      }
+      p = (char *) dbx_malloc(size, 501);
+      if (!p) {
+         return pdata->len_used;
+      }
+      if (pdata->buf_addr) {
+         if (pdata->len_used) {
+            memcpy((void *) p, (void *) pdata->buf_addr, (size_t) pdata->len_used);
+         }
+         dbx_free((void *) pdata->buf_addr, 501);
+      }
+      pdata->buf_addr = p;
+      pdata->len_alloc = size;
+   }
 
    if (context == 0) {
       for (n = 0; n < item_len; n ++) {
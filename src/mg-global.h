@@ -41,6 +41,8 @@ public:
    int            dbx_count;
    char           global_name[256];
    DBXVAL         *pkey;
+   int            key_count;     /* v2.1.20 */
+   DBXGPFX        *pprefix;
    DBX_DBNAME     *c;
 
    static v8::Persistent<v8::Function>       constructor;
@@ -288,6 +288,9 @@ int netx_tcp_connect(DBXCON *pcon, int context)
 
    pcon->net_connection = 0;
    pcon->error_no = 0;
+   pcon->zerocopy = 0; /* v2.1.20 a new socket */
+   pcon->zc_sent = 0;
+   pcon->zc_done = 0;
    connected = 0;
    getaddrinfo_ok = 0;
    spin_count = 0;
@@ -670,11 +673,21 @@ int netx_tcp_handshake(DBXCON *pcon, int context)
    int len;
    char buffer[256];
 
+#if !defined(_WIN32)
+   if (pcon->pipeline) { /* v2.1.20 a server that supports revision 2 of the protocol says so in the header of its reply */
+      sprintf(buffer, "dbx1~%s~2\n", pcon->nspace);
+   }
+   else {
+      sprintf(buffer, "dbx1~%s\n", pcon->nspace);
+   }
+#else
    sprintf(buffer, "dbx1~%s\n", pcon->nspace);
+#endif
    len = (int) strlen(buffer);
 
    netx_tcp_write(pcon, (unsigned char *) buffer, len);
    len = netx_tcp_read(pcon, (unsigned char *) buffer, 5, 10, 0);
+   pcon->net_revision = (pcon->pipeline && len == 5 && buffer[4] == '2') ? 2 : 1;
 
    len = dbx_get_size((unsigned char *) buffer);
  
@@ -701,7 +714,15 @@ int netx_tcp_command(DBXMETH *pmeth, int command, int context)
    unsigned char *netbuf;
    DBXCON *pcon = pmeth->pcon;
 
-   rc = CACHE_SUCCESS;
+#if !defined(_WIN32)
+   if (pcon->pbroker) { /* v2.1.20 sent over a connection of the process-wide broker */
+      return dbx_broker_command(pmeth, command, context);
+   }
+   if (pcon->ppipe) { /* v2.1.20 */
+      return netx_pipe_command(pmeth, command, context);
+   }
+#endif
+
    pcon->error[0] = '\0';
 
    dbx_add_block_size(pmeth->ibuffer, pmeth->ibuffer_used, 0,  DBX_DSORT_EOD, DBX_DTYPE_STR8);
@@ -709,7 +730,7 @@ int netx_tcp_command(DBXMETH *pmeth, int command, int context)
 
    netbuf = (pmeth->ibuffer - DBX_IBUFFER_OFFSET);
    netbuf_used = (pmeth->ibuffer_used + DBX_IBUFFER_OFFSET);
-   dbx_add_block_size(netbuf, 0, netbuf_used,  0, command);
+   dbx_add_block_size(netbuf, 0, netbuf_used + pmeth->iov_len,  0, command); /* v2.1.20 Buffers sent in place count towards the length */
 /*
    {
       char buffer[256];
@@ -717,16 +738,48 @@ int netx_tcp_command(DBXMETH *pmeth, int command, int context)
       dbx_buffer_dump(pcon, netbuf, netbuf_used, buffer, 8, 0);
    }
 */
-   netx_tcp_write(pcon, (unsigned char *) netbuf, netbuf_used);
+   netx_tcp_writev(pcon, pmeth, (unsigned char *) netbuf, netbuf_used, 0); /* v2.1.20 */
    netx_tcp_read(pcon, (unsigned char *) pmeth->output_val.svalue.buf_addr, 5, 10, 0);
    pmeth->output_val.svalue.buf_addr[5] = '\0';
+#if defined(NETX_ZEROCOPY)
+   if (pcon->zc_done != pcon->zc_sent) { /* v2.1.20 the server has read the request: collect the notices that the kernel has finished with the Buffers */
+      netx_tcp_zerocopy_reap(pcon, 1000);
+   }
+#endif
 
    len = dbx_get_block_size((unsigned char *) pmeth->output_val.svalue.buf_addr, 0, &(pmeth->output_val.sort), &(pmeth->output_val.type));
 
+   /* v2.1.20 size the output buffer from the framed length */
+   if (len > 0 && dbx_output_buffer_size(pmeth, (unsigned int) len + 32) != CACHE_SUCCESS) {
+      netx_tcp_discard(pcon, (unsigned char *) pmeth->output_val.svalue.buf_addr, pmeth->output_val.svalue.len_alloc, len);
+      strcpy(pcon->error, "Unable to allocate memory for the response");
+      dbx_request_error(pmeth);
+      pmeth->output_val.svalue.len_used = 0;
+      return CACHE_FAILURE;
+   }
+
    if (len > 0) {
-      netx_tcp_read(pcon, (unsigned char *) pmeth->output_val.svalue.buf_addr, len, 10, 0);
+      netx_tcp_read(pcon, (unsigned char *) pmeth->output_val.svalue.buf_addr, len, 10, 1); /* v2.1.20 large values span several reads */
    }
 
+   rc = netx_tcp_result(pmeth, len);
+   if (pmeth->error[0]) { /* v2.1.20 */
+      T_STRCPY(pcon->error, _dbxso(pcon->error), pmeth->error);
+   }
+   else if (pcon->error[0]) { /* v2.1.20 a failure to write or read is recorded against the request as well */
+      dbx_request_error(pmeth);
+   }
+   return rc;
+}
+
+
+/* v2.1.20 interpret a response read into the request's output buffer: an error is recorded against the request */
+int netx_tcp_result(DBXMETH *pmeth, int len)
+{
+   int rc;
+
+   rc = CACHE_SUCCESS;
+   pmeth->error[0] = '\0';
    if (pmeth->output_val.type == DBX_DTYPE_OREF) {
       pmeth->output_val.svalue.buf_addr[len] = '\0';
       pmeth->output_val.num.oref = (int) strtol(pmeth->output_val.svalue.buf_addr, NULL, 10);
@@ -736,16 +789,19 @@ int netx_tcp_command(DBXMETH *pmeth, int command, int context)
    if (pmeth->output_val.sort == DBX_DSORT_ERROR) {
       rc = CACHE_FAILURE;
       if (len > 0) {
-         strncpy(pcon->error, pmeth->output_val.svalue.buf_addr, len);
-         pcon->error[len] = '\0';
+         if (len >= DBX_ERROR_SIZE) {
+            len = DBX_ERROR_SIZE - 1;
+         }
+         strncpy(pmeth->error, pmeth->output_val.svalue.buf_addr, len);
+         pmeth->error[len] = '\0';
          len = 0;
       }
    }
 /*
    {
       char buffer[256];
-      sprintf(buffer, "netx_tcp_command RECV cmnd=%d; len=%d; sort=%d; type=%d; oref=%d; rc=%d; error=%s;", command, len, pmeth->output_val.sort, pmeth->output_val.type, pmeth->output_val.num.oref, rc, pcon->error);
-      dbx_buffer_dump(pcon, pmeth->output_val.svalue.buf_addr, len, buffer, 8, 0);
+      sprintf(buffer, "netx_tcp_result RECV len=%d; sort=%d; type=%d; oref=%d; rc=%d; error=%s;", len, pmeth->output_val.sort, pmeth->output_val.type, pmeth->output_val.num.oref, rc, pmeth->error);
+      dbx_buffer_dump(pmeth->pcon, pmeth->output_val.svalue.buf_addr, len, buffer, 8, 0);
    }
 */
    pmeth->output_val.svalue.len_used = len;
@@ -754,6 +810,867 @@ int netx_tcp_command(DBXMETH *pmeth, int command, int context)
 }
 
 
+#if !defined(_WIN32)
+
+/* v2.1.20 Start the reader thread for a connection that has negotiated revision 2 of the protocol */
+int netx_pipe_open(DBXCON *pcon)
+{
+   int n;
+   NETXPIPE *ppipe;
+   pthread_attr_t attr;
+
+   ppipe = (NETXPIPE *) dbx_malloc(sizeof(NETXPIPE), 901);
+   if (!ppipe) {
+      strcpy(pcon->error, "Unable to allocate memory for the pipelined connection");
+      return CACHE_FAILURE;
+   }
+   memset((void *) ppipe, 0, sizeof(NETXPIPE));
+   ppipe->pcon = pcon;
+   pthread_mutex_init(&(ppipe->mutex), NULL);
+   pthread_mutex_init(&(ppipe->wmutex), NULL);
+   pthread_cond_init(&(ppipe->cond_free), NULL);
+   for (n = 0; n < NETX_PIPE_SLOTS; n ++) {
+      pthread_cond_init(&(ppipe->slot[n].cond), NULL);
+   }
+
+   pthread_attr_init(&attr);
+   pthread_attr_setstacksize(&attr, DBX_THREAD_STACK_SIZE);
+   n = pthread_create(&(ppipe->reader), &attr, netx_pipe_reader, (void *) ppipe);
+   pthread_attr_destroy(&attr);
+   if (n) {
+      for (n = 0; n < NETX_PIPE_SLOTS; n ++) {
+         pthread_cond_destroy(&(ppipe->slot[n].cond));
+      }
+      pthread_cond_destroy(&(ppipe->cond_free));
+      pthread_mutex_destroy(&(ppipe->wmutex));
+      pthread_mutex_destroy(&(ppipe->mutex));
+      dbx_free((void *) ppipe, 901);
+      strcpy(pcon->error, "Unable to start the reader thread for the pipelined connection");
+      return CACHE_FAILURE;
+   }
+   pcon->ppipe = (void *) ppipe;
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 Stop the reader thread: every thread that sends requests over the connection must have finished with it */
+int netx_pipe_close(DBXCON *pcon)
+{
+   int n;
+   NETXPIPE *ppipe;
+
+   ppipe = (NETXPIPE *) pcon->ppipe;
+   if (!ppipe) {
+      return 0;
+   }
+   pcon->ppipe = NULL;
+
+   NETX_SHUTDOWN(pcon->cli_socket, SHUT_RDWR); /* wakes the reader */
+   pthread_join(ppipe->reader, NULL);
+
+   for (n = 0; n < NETX_PIPE_SLOTS; n ++) {
+      pthread_cond_destroy(&(ppipe->slot[n].cond));
+   }
+   pthread_cond_destroy(&(ppipe->cond_free));
+   pthread_mutex_destroy(&(ppipe->wmutex));
+   pthread_mutex_destroy(&(ppipe->mutex));
+   dbx_free((void *) ppipe, 901);
+
+   return 0;
+}
+
+
+/* v2.1.20 Send a request over a pipelined connection and wait for the reader thread to hand back its response */
+int netx_pipe_command(DBXMETH *pmeth, int command, int context)
+{
+   int n, rc;
+   unsigned int id, netbuf_used;
+   unsigned char *netbuf;
+   DBXCON *pcon = pmeth->pcon;
+   NETXPIPE *ppipe = (NETXPIPE *) pcon->ppipe;
+   NETXPIPESLOT *pslot;
+
+   pcon->error[0] = '\0';
+   pmeth->error[0] = '\0';
+
+   dbx_add_block_size(pmeth->ibuffer, pmeth->ibuffer_used, 0,  DBX_DSORT_EOD, DBX_DTYPE_STR8);
+   pmeth->ibuffer_used += 5;
+
+   netbuf = (pmeth->ibuffer - DBX_IBUFFER_OFFSET);
+   netbuf_used = (pmeth->ibuffer_used + DBX_IBUFFER_OFFSET);
+   dbx_add_block_size(netbuf, 0, netbuf_used + pmeth->iov_len,  0, command);
+
+   pthread_mutex_lock(&(ppipe->mutex));
+   while (!ppipe->closed && ppipe->inflight >= NETX_PIPE_SLOTS) {
+      pthread_cond_wait(&(ppipe->cond_free), &(ppipe->mutex));
+   }
+   if (ppipe->closed) {
+      pthread_mutex_unlock(&(ppipe->mutex));
+      strcpy(pcon->error, "Connection to the server lost");
+      pmeth->output_val.svalue.len_used = 0;
+      return CACHE_NOCON;
+   }
+   do {
+      id = ++ ppipe->next_id;
+   } while (!id || ppipe->slot[id & (NETX_PIPE_SLOTS - 1)].id);
+   pslot = &(ppipe->slot[id & (NETX_PIPE_SLOTS - 1)]);
+   pslot->id = id;
+   pslot->pmeth = pmeth;
+   pslot->done = 0;
+   pslot->rc = CACHE_SUCCESS;
+   ppipe->inflight ++;
+   if (ppipe->inflight > ppipe->inflight_peak) {
+      ppipe->inflight_peak = ppipe->inflight;
+   }
+   ppipe->requests ++;
+   pthread_mutex_unlock(&(ppipe->mutex));
+
+   dbx_set_size(netbuf + 10, (unsigned long) id); /* the request ID travels in the index field of the header and is returned ahead of the response */
+
+   pthread_mutex_lock(&(ppipe->wmutex));
+   n = netx_tcp_writev(ppipe->pcon, pmeth, (unsigned char *) netbuf, netbuf_used, 1); /* no MSG_ZEROCOPY: the reader thread owns the socket's notices */
+   pthread_mutex_unlock(&(ppipe->wmutex));
+   if (n != (int) (netbuf_used + pmeth->iov_len)) {
+      NETX_SHUTDOWN(ppipe->pcon->cli_socket, SHUT_RDWR); /* the reader fails every request in progress, this one included */
+   }
+
+   pthread_mutex_lock(&(ppipe->mutex));
+   while (!pslot->done) {
+      pthread_cond_wait(&(pslot->cond), &(ppipe->mutex));
+   }
+   rc = pslot->rc;
+   pslot->id = 0;
+   pslot->pmeth = NULL;
+   ppipe->inflight --;
+   pthread_cond_signal(&(ppipe->cond_free));
+   pthread_mutex_unlock(&(ppipe->mutex));
+
+   if (pmeth->error[0]) { /* recorded against the request by the reader thread */
+      T_STRCPY(pcon->error, _dbxso(pcon->error), pmeth->error);
+   }
+   return rc;
+}
+
+
+/* v2.1.20 The only thread to read from a pipelined connection: responses may arrive in any order */
+void * netx_pipe_reader(void *data)
+{
+   int n, len, rc, sort, type;
+   unsigned int id;
+   unsigned char head[9], scratch[256];
+   NETXPIPE *ppipe = (NETXPIPE *) data;
+   NETXPIPESLOT *pslot;
+   DBXMETH *pmeth;
+
+   while (1) {
+      /* request ID (4 bytes) then the usual block header (5 bytes) */
+      if (netx_tcp_read(ppipe->pcon, head, 9, -1, 1) != 9) {
+         break;
+      }
+      id = (unsigned int) dbx_get_size(head);
+      len = (int) dbx_get_block_size(head, 4, &sort, &type);
+
+      pmeth = NULL;
+      pthread_mutex_lock(&(ppipe->mutex));
+      pslot = &(ppipe->slot[id & (NETX_PIPE_SLOTS - 1)]);
+      if (id && pslot->id == id && !pslot->done) {
+         pmeth = pslot->pmeth; /* the slot is not released until the response has been handed over */
+      }
+      pthread_mutex_unlock(&(ppipe->mutex));
+
+      rc = CACHE_SUCCESS;
+      if (!pmeth) { /* no request is waiting for this response */
+         while (len > 0) {
+            n = netx_tcp_read(ppipe->pcon, scratch, len > (int) sizeof(scratch) ? (int) sizeof(scratch) : len, -1, 1);
+            if (n < 1) {
+               break;
+            }
+            len -= n;
+         }
+         if (len > 0) {
+            break;
+         }
+         continue;
+      }
+
+      pmeth->output_val.sort = sort;
+      pmeth->output_val.type = type;
+      if (len > 0 && dbx_output_buffer_size(pmeth, (unsigned int) len + 32) != CACHE_SUCCESS) {
+         while (len > 0) {
+            n = netx_tcp_read(ppipe->pcon, scratch, len > (int) sizeof(scratch) ? (int) sizeof(scratch) : len, -1, 1);
+            if (n < 1) {
+               break;
+            }
+            len -= n;
+         }
+         if (len > 0) {
+            break;
+         }
+         strcpy(pmeth->error, "Unable to allocate memory for the response");
+         pmeth->output_val.svalue.len_used = 0;
+         rc = CACHE_FAILURE;
+      }
+      else {
+         if (len > 0 && netx_tcp_read(ppipe->pcon, (unsigned char *) pmeth->output_val.svalue.buf_addr, len, -1, 1) != len) {
+            break;
+         }
+         rc = netx_tcp_result(pmeth, len);
+      }
+
+      pthread_mutex_lock(&(ppipe->mutex));
+      pslot->rc = rc;
+      pslot->done = 1;
+      pthread_cond_signal(&(pslot->cond));
+      pthread_mutex_unlock(&(ppipe->mutex));
+   }
+
+   /* the connection has been closed: fail the requests still waiting for a response */
+   pthread_mutex_lock(&(ppipe->mutex));
+   ppipe->closed = 1;
+   for (n = 0; n < NETX_PIPE_SLOTS; n ++) {
+      pslot = &(ppipe->slot[n]);
+      if (pslot->id && !pslot->done) {
+         strcpy(pslot->pmeth->error, "Connection to the server lost");
+         pslot->pmeth->output_val.svalue.len_used = 0;
+         pslot->rc = CACHE_NOCON;
+         pslot->done = 1;
+         pthread_cond_signal(&(pslot->cond));
+      }
+   }
+   pthread_cond_broadcast(&(ppipe->cond_free));
+   pthread_mutex_unlock(&(ppipe->mutex));
+
+   return NULL;
+}
+
+/* v2.1.20 Connect the event-loop transport: pool_size connections of the server's own, each negotiating revision 2 of the protocol */
+int netx_uv_open(DBXCON *pcon, uv_loop_t *loop)
+{
+   int n, m, size, flags;
+   NETXUV *puv;
+   NETXUVCON *pconn;
+   DBXCON *pcon_uv;
+
+   size = (pcon->pool_size > 0 ? pcon->pool_size : 1);
+
+   puv = (NETXUV *) dbx_malloc(sizeof(NETXUV), 901);
+   if (!puv) {
+      strcpy(pcon->error, "Unable to allocate memory for the event-loop transport");
+      return CACHE_FAILURE;
+   }
+   memset((void *) puv, 0, sizeof(NETXUV));
+   puv->con = (NETXUVCON *) dbx_malloc(sizeof(NETXUVCON) * size, 901);
+   puv->pfd = (struct pollfd *) dbx_malloc(sizeof(struct pollfd) * size, 901);
+   if (!puv->con || !puv->pfd) {
+      if (puv->con) {
+         dbx_free((void *) puv->con, 901);
+      }
+      if (puv->pfd) {
+         dbx_free((void *) puv->pfd, 901);
+      }
+      dbx_free((void *) puv, 901);
+      strcpy(pcon->error, "Unable to allocate memory for the event-loop transport");
+      return CACHE_FAILURE;
+   }
+   memset((void *) puv->con, 0, sizeof(NETXUVCON) * size);
+
+   /* make every connection before any of them is handed to the event loop */
+   for (n = 0; n < size; n ++) {
+      pconn = &(puv->con[n]);
+      pconn->puv = puv;
+      pcon_uv = (DBXCON *) dbx_malloc(sizeof(DBXCON), 901);
+      if (!pcon_uv) {
+         strcpy(pcon->error, "Unable to allocate memory for the event-loop transport");
+         break;
+      }
+      memcpy((void *) pcon_uv, (void *) pcon, sizeof(DBXCON));
+      pcon_uv->error[0] = '\0';
+      pcon_uv->pmeth_base = NULL;
+      pcon_uv->pmeth_pool = NULL;
+      pcon_uv->pasync = NULL;
+      pcon_uv->ppool = NULL;
+      pcon_uv->pbroker = NULL;
+      pcon_uv->ppipe = NULL;
+      pcon_uv->puv = NULL;
+      pcon_uv->cli_socket = (SOCKET) 0;
+      pcon_uv->rbuf = NULL;
+      pcon_uv->mutex_net.created = 0;
+      pcon_uv->pipeline = 1;
+      pcon_uv->net_revision = 1;
+      pconn->pcon = pcon_uv;
+
+      if (netx_tcp_connect(pcon_uv, 0) != CACHE_SUCCESS) {
+         T_STRCPY(pcon->error, _dbxso(pcon->error), pcon_uv->error);
+         break;
+      }
+      pcon_uv->p_zv = &(pcon_uv->zv);
+      if (netx_tcp_handshake(pcon_uv, 0) != CACHE_SUCCESS) {
+         T_STRCPY(pcon->error, _dbxso(pcon->error), pcon_uv->error);
+         break;
+      }
+      if (pcon_uv->net_revision != 2) {
+         strcpy(pcon->error, "The server does not support revision 2 of the protocol");
+         break;
+      }
+      flags = fcntl(pcon_uv->cli_socket, F_GETFL, 0);
+      fcntl(pcon_uv->cli_socket, F_SETFL, flags | O_NONBLOCK);
+   }
+
+   if (n == size) {
+      for (m = 0; m < size; m ++) {
+         pconn = &(puv->con[m]);
+         if (uv_poll_init(loop, &(pconn->poll), (int) pconn->pcon->cli_socket)) {
+            break;
+         }
+         pconn->poll.data = (void *) pconn;
+         puv->handles ++;
+         uv_unref((uv_handle_t *) &(pconn->poll)); /* only outstanding requests (DBXASYNC) keep the loop alive */
+         pconn->events = UV_READABLE; /* a connection lost while idle is noticed */
+         uv_poll_start(&(pconn->poll), pconn->events, netx_uv_poll_callback);
+      }
+      if (m == size) {
+         puv->size = size;
+         pcon->puv = (void *) puv;
+         return CACHE_SUCCESS;
+      }
+      strcpy(pcon->error, "Unable to watch the connections of the event-loop transport");
+      puv->size = size;
+      puv->closing = 1;
+      n = puv->handles;
+      for (m = 0; m < size; m ++) {
+         pconn = &(puv->con[m]);
+         if (pconn->poll.data) {
+            uv_poll_stop(&(pconn->poll));
+            uv_close((uv_handle_t *) &(pconn->poll), netx_uv_close_callback);
+         }
+         else {
+            netx_tcp_disconnect(pconn->pcon, 0);
+            dbx_free((void *) pconn->pcon, 901);
+            pconn->pcon = NULL;
+         }
+      }
+      if (n == 0) { /* no close callback to release it */
+         dbx_free((void *) puv->pfd, 901);
+         dbx_free((void *) puv->con, 901);
+         dbx_free((void *) puv, 901);
+      }
+      return CACHE_FAILURE;
+   }
+
+   for (m = 0; m <= n && m < size; m ++) {
+      pconn = &(puv->con[m]);
+      if (pconn->pcon) {
+         if (pconn->pcon->net_connection || pconn->pcon->rbuf) {
+            netx_tcp_disconnect(pconn->pcon, 0);
+         }
+         dbx_free((void *) pconn->pcon, 901);
+      }
+   }
+   dbx_free((void *) puv->pfd, 901);
+   dbx_free((void *) puv->con, 901);
+   dbx_free((void *) puv, 901);
+   return CACHE_FAILURE;
+}
+
+
+/* v2.1.20 Requests in progress are answered first: the connections are then closed by the event loop */
+int netx_uv_close(DBXCON *pcon)
+{
+   int n;
+   NETXUV *puv;
+   NETXUVCON *pconn;
+
+   puv = (NETXUV *) pcon->puv;
+   if (!puv) {
+      return 0;
+   }
+   pcon->puv = NULL;
+   puv->closing = 1;
+
+   while (netx_uv_load(puv) > 0 && netx_uv_service(puv, -1) > 0) {
+      ;
+   }
+
+   for (n = 0; n < puv->size; n ++) {
+      pconn = &(puv->con[n]);
+      netx_uv_lost(pconn); /* anything left is failed */
+      uv_close((uv_handle_t *) &(pconn->poll), netx_uv_close_callback);
+   }
+   return 0;
+}
+
+
+void netx_uv_close_callback(uv_handle_t *handle)
+{
+   NETXUVCON *pconn = (NETXUVCON *) handle->data;
+   NETXUV *puv = pconn->puv;
+
+   if (pconn->pcon) {
+      netx_tcp_disconnect(pconn->pcon, 0);
+      dbx_free((void *) pconn->pcon, 901);
+      pconn->pcon = NULL;
+   }
+   if (-- puv->handles == 0) {
+      dbx_free((void *) puv->pfd, 901);
+      dbx_free((void *) puv->con, 901);
+      dbx_free((void *) puv, 901);
+   }
+   return;
+}
+
+
+/* v2.1.20 Queue a request on the least loaded connection and write as much of it as the socket will take */
+int netx_uv_command(DBXMETH *pmeth, int command)
+{
+   int n;
+   unsigned int netbuf_used;
+   unsigned char *netbuf;
+   NETXUV *puv = (NETXUV *) pmeth->pcon->puv;
+   NETXUVCON *pconn;
+
+   if (!puv || puv->closing) {
+      return CACHE_FAILURE;
+   }
+   pconn = NULL;
+   for (n = 0; n < puv->size; n ++) {
+      if (!puv->con[n].closed && (!pconn || puv->con[n].load < pconn->load)) {
+         pconn = &(puv->con[n]);
+      }
+   }
+   if (!pconn) { /* every connection has been lost */
+      return CACHE_FAILURE;
+   }
+
+   dbx_add_block_size(pmeth->ibuffer, pmeth->ibuffer_used, 0,  DBX_DSORT_EOD, DBX_DTYPE_STR8);
+   pmeth->ibuffer_used += 5;
+
+   netbuf = (pmeth->ibuffer - DBX_IBUFFER_OFFSET);
+   netbuf_used = (pmeth->ibuffer_used + DBX_IBUFFER_OFFSET);
+   dbx_add_block_size(netbuf, 0, netbuf_used + pmeth->iov_len,  0, command);
+
+   pmeth->net_id = 0;
+   pmeth->net_sent = 0;
+   pmeth->error[0] = '\0'; /* the connection's error is shared with every other request: the outcome is recorded against the request */
+   pmeth->error_code = 0;
+   pmeth->task.pmeth = pmeth;
+   pmeth->task.next = NULL;
+   if (pconn->wq_tail) {
+      pconn->wq_tail->task.next = &(pmeth->task);
+   }
+   else {
+      pconn->wq_head = pmeth;
+   }
+   pconn->wq_tail = pmeth;
+   pconn->load ++;
+   puv->requests ++;
+   n = netx_uv_load(puv);
+   if (n > puv->inflight_peak) {
+      puv->inflight_peak = n;
+   }
+
+   if (pconn->wq_head == pmeth) {
+      if (netx_uv_write(pconn) < 0) {
+         netx_uv_lost(pconn);
+         return CACHE_SUCCESS; /* failed with the other requests on the connection */
+      }
+   }
+   netx_uv_events(pconn);
+
+   return CACHE_SUCCESS;
+}
+
+
+/* v2.1.20 Requests not yet answered over all connections */
+int netx_uv_load(NETXUV *puv)
+{
+   int n, load;
+
+   load = 0;
+   for (n = 0; n < puv->size; n ++) {
+      load += puv->con[n].load;
+   }
+   return load;
+}
+
+
+/* v2.1.20 Wait for, and deal with, I/O on the connections that have requests in progress: used where the primary thread must not return to the event loop */
+int netx_uv_service(NETXUV *puv, int timeout_ms)
+{
+   int n, m, nfds;
+   NETXUVCON *pconn;
+
+   nfds = 0;
+   for (n = 0; n < puv->size; n ++) {
+      pconn = &(puv->con[n]);
+      if (pconn->closed || pconn->load == 0) {
+         continue;
+      }
+      puv->pfd[nfds].fd = (int) pconn->pcon->cli_socket;
+      puv->pfd[nfds].events = POLLIN | (pconn->want_write ? POLLOUT : 0);
+      puv->pfd[nfds].revents = 0;
+      nfds ++;
+   }
+   if (nfds == 0) {
+      return -1;
+   }
+
+   do {
+      n = NETX_POLL(puv->pfd, nfds, timeout_ms);
+   } while (n < 0 && errno == EINTR);
+   if (n <= 0) {
+      return n;
+   }
+
+   for (m = 0; m < nfds; m ++) {
+      if (!puv->pfd[m].revents) {
+         continue;
+      }
+      for (n = 0; n < puv->size; n ++) {
+         pconn = &(puv->con[n]);
+         if (!pconn->closed && (int) pconn->pcon->cli_socket == puv->pfd[m].fd) {
+            netx_uv_io(pconn, (puv->pfd[m].revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL)) ? 1 : 0, (puv->pfd[m].revents & POLLOUT) ? 1 : 0);
+            break;
+         }
+      }
+   }
+   return 1;
+}
+
+
+void netx_uv_poll_callback(uv_poll_t *handle, int status, int events)
+{
+   NETXUVCON *pconn = (NETXUVCON *) handle->data;
+
+   if (status < 0) {
+      netx_uv_lost(pconn);
+      return;
+   }
+   netx_uv_io(pconn, (events & UV_READABLE) ? 1 : 0, (events & UV_WRITABLE) ? 1 : 0);
+   return;
+}
+
+
+void netx_uv_io(NETXUVCON *pconn, int readable, int writable)
+{
+   if (pconn->closed) {
+      return;
+   }
+   if (readable && netx_uv_read(pconn) < 0) {
+      netx_uv_lost(pconn);
+      return;
+   }
+   if (pconn->wq_head && (writable || !pconn->want_write) && netx_uv_write(pconn) < 0) { /* responses may have freed slots for requests held back */
+      netx_uv_lost(pconn);
+      return;
+   }
+   netx_uv_events(pconn);
+   return;
+}
+
+
+/* v2.1.20 Ask the event loop to report writability only while there is something the socket would not take */
+void netx_uv_events(NETXUVCON *pconn)
+{
+   int events;
+
+   if (pconn->closed) {
+      return;
+   }
+   events = UV_READABLE | (pconn->want_write ? UV_WRITABLE : 0);
+   if (events != pconn->events) {
+      pconn->events = events;
+      uv_poll_start(&(pconn->poll), events, netx_uv_poll_callback);
+   }
+   return;
+}
+
+
+/* v2.1.20 Write queued requests, each with its own ID, until the queue is empty (0), the socket is full (1) or the connection fails (-1) */
+int netx_uv_write(NETXUVCON *pconn)
+{
+   int n, iovn, segn;
+   unsigned int id, offset, pos, skip, total, netbuf_used;
+   unsigned char *netbuf;
+   struct iovec iov[(DBX_IOV_MAX * 2) + 1];
+   struct msghdr msg;
+   DBXMETH *pmeth;
+
+   pconn->want_write = 0;
+   while ((pmeth = pconn->wq_head)) {
+      netbuf = (pmeth->ibuffer - DBX_IBUFFER_OFFSET);
+      netbuf_used = (pmeth->ibuffer_used + DBX_IBUFFER_OFFSET);
+      total = netbuf_used + pmeth->iov_len;
+
+      if (!pmeth->net_id) {
+         if (pconn->inflight >= NETX_UV_SLOTS) { /* held back until a response frees a slot */
+            return 0;
+         }
+         do {
+            id = ++ pconn->next_id;
+         } while (!id || pconn->slot[id & (NETX_UV_SLOTS - 1)]);
+         pconn->slot[id & (NETX_UV_SLOTS - 1)] = pmeth;
+         pconn->inflight ++;
+         pmeth->net_id = id;
+         dbx_set_size(netbuf + 10, (unsigned long) id);
+      }
+
+      /* the request buffer interleaved with any Buffers sent in place, less what has been written */
+      segn = 0;
+      offset = 0;
+      for (n = 0; n <= pmeth->iov_n; n ++) {
+         pos = (n < pmeth->iov_n) ? (pmeth->iov[n].offset + DBX_IBUFFER_OFFSET) : netbuf_used;
+         if (pos > offset) {
+            iov[segn].iov_base = (void *) (netbuf + offset);
+            iov[segn ++].iov_len = (size_t) (pos - offset);
+            offset = pos;
+         }
+         if (n < pmeth->iov_n) {
+            iov[segn].iov_base = (void *) pmeth->iov[n].data;
+            iov[segn ++].iov_len = (size_t) pmeth->iov[n].len;
+         }
+      }
+      skip = pmeth->net_sent;
+      for (iovn = 0; iovn < segn && skip >= (unsigned int) iov[iovn].iov_len; iovn ++) {
+         skip -= (unsigned int) iov[iovn].iov_len;
+      }
+      iov[iovn].iov_base = (void *) ((char *) iov[iovn].iov_base + skip);
+      iov[iovn].iov_len -= (size_t) skip;
+
+      memset((void *) &msg, 0, sizeof(msg));
+      msg.msg_iov = &(iov[iovn]);
+      msg.msg_iovlen = segn - iovn;
+      n = (int) sendmsg(pconn->pcon->cli_socket, &msg, 0);
+      if (n < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            pconn->want_write = 1;
+            return 1;
+         }
+         return -1;
+      }
+      pmeth->net_sent += (unsigned int) n;
+      if (pmeth->net_sent == total) { /* written: it waits in its slot for the response */
+         pconn->wq_head = pmeth->task.next ? pmeth->task.next->pmeth : NULL;
+         if (!pconn->wq_head) {
+            pconn->wq_tail = NULL;
+         }
+         pmeth->task.next = NULL;
+      }
+   }
+   return 0;
+}
+
+
+/* v2.1.20 Read whatever the socket has: responses may arrive in any order and in any number of pieces */
+int netx_uv_read(NETXUVCON *pconn)
+{
+   int n, avail;
+   DBXCON *pcon = pconn->pcon;
+   DBXMETH *pmeth;
+
+   if (!pcon->rbuf) {
+      pcon->rbuf = (unsigned char *) dbx_malloc(NETX_RECV_BUFFER, 901);
+      if (!pcon->rbuf) {
+         return -1;
+      }
+      pcon->rbuf_pos = 0;
+      pcon->rbuf_len = 0;
+   }
+
+   while (1) {
+      if (pcon->rbuf_pos >= pcon->rbuf_len) {
+         pmeth = pconn->pread;
+         if (pmeth && !pconn->discard && (pconn->body_len - pconn->body_got) >= NETX_RECV_BUFFER) { /* the rest of a large response goes straight to the request's buffer */
+            n = (int) NETX_RECV(pcon->cli_socket, (char *) pmeth->output_val.svalue.buf_addr + pconn->body_got, pconn->body_len - pconn->body_got, 0);
+         }
+         else {
+            pmeth = NULL;
+            n = (int) NETX_RECV(pcon->cli_socket, (char *) pcon->rbuf, NETX_RECV_BUFFER, 0);
+         }
+         if (n == 0) {
+            return -1;
+         }
+         if (n < 0) {
+            if (errno == EINTR) {
+               continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+               return 0;
+            }
+            return -1;
+         }
+         if (pmeth) {
+            pconn->body_got += n;
+            if (pconn->body_got == pconn->body_len) {
+               netx_uv_response(pconn);
+            }
+            continue;
+         }
+         pcon->rbuf_pos = 0;
+         pcon->rbuf_len = n;
+      }
+
+      avail = pcon->rbuf_len - pcon->rbuf_pos;
+      if (pconn->head_got < 9) {
+         n = (9 - pconn->head_got) < avail ? (9 - pconn->head_got) : avail;
+         memcpy((void *) (pconn->head + pconn->head_got), (void *) (pcon->rbuf + pcon->rbuf_pos), (size_t) n);
+         pconn->head_got += n;
+         pcon->rbuf_pos += n;
+         if (pconn->head_got == 9) {
+            netx_uv_header(pconn);
+         }
+         continue;
+      }
+      n = (pconn->body_len - pconn->body_got) < avail ? (pconn->body_len - pconn->body_got) : avail;
+      if (pconn->pread && !pconn->discard) {
+         memcpy((void *) (pconn->pread->output_val.svalue.buf_addr + pconn->body_got), (void *) (pcon->rbuf + pcon->rbuf_pos), (size_t) n);
+      }
+      pconn->body_got += n;
+      pcon->rbuf_pos += n;
+      if (pconn->body_got == pconn->body_len) {
+         netx_uv_response(pconn);
+      }
+   }
+   return 0;
+}
+
+
+/* v2.1.20 The request ID and block header of a response have been read: find the request waiting for it */
+void netx_uv_header(NETXUVCON *pconn)
+{
+   int sort, type;
+   unsigned int id;
+   DBXMETH *pmeth;
+
+   id = (unsigned int) dbx_get_size(pconn->head);
+   pconn->body_len = (int) dbx_get_block_size(pconn->head, 4, &sort, &type);
+   pconn->body_got = 0;
+   pconn->discard = 0;
+
+   pmeth = pconn->slot[id & (NETX_UV_SLOTS - 1)];
+   if (!id || !pmeth || pmeth->net_id != id) { /* no request is waiting for this response */
+      pmeth = NULL;
+      pconn->discard = 1;
+   }
+   else {
+      pmeth->output_val.sort = sort;
+      pmeth->output_val.type = type;
+      if (pconn->body_len > 0 && dbx_output_buffer_size(pmeth, (unsigned int) pconn->body_len + 32) != CACHE_SUCCESS) {
+         pconn->discard = 2;
+      }
+   }
+   pconn->pread = pmeth;
+
+   if (pconn->body_len == 0) {
+      netx_uv_response(pconn);
+   }
+   return;
+}
+
+
+/* v2.1.20 A response has been read in full: hand it back through the connection's completion channel */
+void netx_uv_response(NETXUVCON *pconn)
+{
+   DBXMETH *pmeth = pconn->pread;
+
+   if (pmeth) {
+      if (pconn->discard) {
+         strcpy(pmeth->error, "Unable to allocate memory for the response");
+         pmeth->output_val.svalue.len_used = 0;
+      }
+      else {
+         netx_tcp_result(pmeth, pconn->body_len);
+      }
+      netx_uv_complete(pconn, pmeth);
+   }
+   pconn->head_got = 0;
+   pconn->pread = NULL;
+   pconn->body_len = 0;
+   pconn->body_got = 0;
+   pconn->discard = 0;
+   return;
+}
+
+
+void netx_uv_complete(NETXUVCON *pconn, DBXMETH *pmeth)
+{
+   if (pmeth->net_id) {
+      pconn->slot[pmeth->net_id & (NETX_UV_SLOTS - 1)] = NULL;
+      pconn->inflight --;
+      pmeth->net_id = 0;
+   }
+   pconn->load --;
+   dbx_async_release(&(pmeth->task));
+   dbx_async_complete(&(pmeth->task));
+   return;
+}
+
+
+/* v2.1.20 The connection has failed (or is being closed): fail the requests still on it */
+void netx_uv_lost(NETXUVCON *pconn)
+{
+   int n;
+   DBXMETH *pmeth, *pnext;
+
+   if (!pconn->closed) {
+      pconn->closed = 1;
+      if (!pconn->puv->closing) {
+         pconn->puv->lost ++;
+      }
+      uv_poll_stop(&(pconn->poll));
+   }
+
+   pmeth = pconn->wq_head;
+   pconn->wq_head = NULL;
+   pconn->wq_tail = NULL;
+   for (; pmeth; pmeth = pnext) {
+      pnext = pmeth->task.next ? pmeth->task.next->pmeth : NULL;
+      pmeth->task.next = NULL;
+      if (pmeth->net_id) { /* partly written: it is failed from its slot */
+         continue;
+      }
+      strcpy(pmeth->error, "Connection to the server lost");
+      pmeth->output_val.svalue.len_used = 0;
+      netx_uv_complete(pconn, pmeth);
+   }
+   for (n = 0; n < NETX_UV_SLOTS && pconn->inflight > 0; n ++) {
+      pmeth = pconn->slot[n];
+      if (pmeth) {
+         strcpy(pmeth->error, "Connection to the server lost");
+         pmeth->output_val.svalue.len_used = 0;
+         netx_uv_complete(pconn, pmeth);
+      }
+   }
+   pconn->pread = NULL;
+   pconn->want_write = 0;
+   return;
+}
+
+
+
+#endif
+
+
+/* v2.1.20 read and throw away a response that could not be stored */
+int netx_tcp_discard(DBXCON *pcon, unsigned char *buffer, int buffer_size, int len)
+{
+   int chunk, rc;
+
+   while (len > 0) {
+      chunk = (len > buffer_size) ? buffer_size : len;
+      rc = netx_tcp_read(pcon, buffer, chunk, 10, 0);
+      if (rc <= 0) {
+         return rc;
+      }
+      len -= rc;
+   }
+   return 0;
+}
+
+
 int netx_tcp_connect_ex(DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_addr_len, int timeout)
 {
 #if defined(_WIN32)
@@ -761,8 +1678,6 @@ int netx_tcp_connect_ex(DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_a
 #else
    int flags, n, error;
    socklen_netx len;
-   fd_set rset, wset;
-   struct timeval tval;
 #endif
 
 #if defined(SOLARIS) && BIT64PLAT
@@ -810,14 +1725,8 @@ int netx_tcp_connect_ex(DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_a
 
       if (n != 0) {
 
-         FD_ZERO(&rset);
-         FD_SET(pcon->cli_socket, &rset);
-
-         wset = rset;
-         tval.tv_sec = timeout;
-         tval.tv_usec = timeout;
-
-         n = NETX_SELECT((int) (pcon->cli_socket + 1), &rset, &wset, NULL, &tval);
+         /* v2.1.20 the outcome of the connection is reported through SO_ERROR once the socket is writable */
+         n = netx_tcp_wait(pcon->cli_socket, POLLIN | POLLOUT, timeout * 1000);
 
          if (n == 0) {
             close(pcon->cli_socket);
@@ -825,7 +1734,7 @@ int netx_tcp_connect_ex(DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_a
 
             return (-2);
          }
-         if (NETX_FD_ISSET(pcon->cli_socket, &rset) || NETX_FD_ISSET(pcon->cli_socket, &wset)) {
+         if (n > 0) {
 
             len = sizeof(error);
             if (NETX_GETSOCKOPT(pcon->cli_socket, SOL_SOCKET, SO_ERROR, (void *) &error, &len) < 0) {
@@ -887,11 +1796,48 @@ int netx_tcp_disconnect(DBXCON *pcon, int context)
 
    pcon->net_connection = 0;
 
+   if (pcon->rbuf) { /* v2.1.20 */
+      dbx_free((void *) pcon->rbuf, 901);
+      pcon->rbuf = NULL;
+   }
+   pcon->rbuf_pos = 0;
+   pcon->rbuf_len = 0;
+   pcon->zerocopy = 0;
+   pcon->zc_sent = 0;
+   pcon->zc_done = 0;
+
    return 0;
 
 }
 
 
+/* v2.1.20 Check without blocking that the server has not closed a connection that has been idle */
+int netx_tcp_alive(DBXCON *pcon, int context)
+{
+#if !defined(_WIN32)
+   int n;
+   char c;
+
+   if (!pcon || pcon->cli_socket == (SOCKET) 0 || !pcon->net_connection) {
+      return CACHE_NOCON;
+   }
+   if (pcon->rbuf_len > pcon->rbuf_pos) { /* buffered data that no request is waiting for */
+      return CACHE_NOCON;
+   }
+
+   n = (int) recv(pcon->cli_socket, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+   if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      return CACHE_SUCCESS;
+   }
+
+   /* closed by the server (0), failed, or holding unsolicited data that would be taken as the next response */
+   return CACHE_NOCON;
+#else
+   return CACHE_SUCCESS;
+#endif
+}
+
+
 int netx_tcp_write(DBXCON *pcon, unsigned char *data, int size)
 {
    int n = 0, errorno = 0, char_sent = 0;
@@ -941,81 +1887,313 @@ int netx_tcp_write(DBXCON *pcon, unsigned char *data, int size)
 }
 
 
+/* v2.1.20 Send a request whose large Buffer arguments are held in place (pmeth->iov): the pieces go out in order with as few calls as possible */
+int netx_tcp_writev(DBXCON *pcon, DBXMETH *pmeth, unsigned char *netbuf, unsigned int netbuf_used, int context)
+{
+   int n, segn;
+   unsigned int offset, pos, total;
+   unsigned char *seg[(DBX_IOV_MAX * 2) + 1];
+   unsigned int seg_len[(DBX_IOV_MAX * 2) + 1];
+#if !defined(_WIN32)
+   int flags, errorno;
+   unsigned int sent;
+   struct iovec iov[(DBX_IOV_MAX * 2) + 1], *piov;
+   struct msghdr msg;
+#endif
 
-int netx_tcp_read(DBXCON *pcon, unsigned char *data, int size, int timeout, int context)
+   if (!pmeth->iov_n) {
+      return netx_tcp_write(pcon, netbuf, (int) netbuf_used);
+   }
+
+   if (pcon->net_connection == 0) {
+      strcpy(pcon->error, "TCP Write Error: Socket is Closed");
+      return -1;
+   }
+
+   segn = 0;
+   offset = 0;
+   for (n = 0; n < pmeth->iov_n; n ++) {
+      pos = pmeth->iov[n].offset + DBX_IBUFFER_OFFSET;
+      if (pos > offset) {
+         seg[segn] = netbuf + offset;
+         seg_len[segn ++] = pos - offset;
+         offset = pos;
+      }
+      seg[segn] = (unsigned char *) pmeth->iov[n].data;
+      seg_len[segn ++] = pmeth->iov[n].len;
+   }
+   seg[segn] = netbuf + offset;
+   seg_len[segn ++] = netbuf_used - offset;
+   total = netbuf_used + pmeth->iov_len;
+
+#if defined(_WIN32)
+   for (n = 0; n < segn; n ++) {
+      if (netx_tcp_write(pcon, seg[n], (int) seg_len[n]) != (int) seg_len[n]) {
+         return -1;
+      }
+   }
+#else
+   for (n = 0; n < segn; n ++) {
+      iov[n].iov_base = (void *) seg[n];
+      iov[n].iov_len = (size_t) seg_len[n];
+   }
+   piov = iov;
+
+   flags = 0;
+#if defined(NETX_ZEROCOPY)
+   if (context == 0 && pmeth->iov_len >= DBX_IOV_ZEROCOPY_SIZE && netx_tcp_zerocopy(pcon)) {
+      flags |= MSG_ZEROCOPY;
+   }
+#endif
+
+   sent = 0;
+   while (sent < total) {
+      memset((void *) &msg, 0, sizeof(msg));
+      msg.msg_iov = piov;
+      msg.msg_iovlen = segn;
+      n = (int) sendmsg(pcon->cli_socket, &msg, flags);
+      if (n < 0) {
+         errorno = (int) netx_get_last_error(0);
+         if (errorno == EINTR) {
+            continue;
+         }
+#if defined(NETX_ZEROCOPY)
+         if ((flags & MSG_ZEROCOPY) && errorno == ENOBUFS) { /* no room left to queue the completion notices: copy instead */
+            flags &= ~MSG_ZEROCOPY;
+            continue;
+         }
+#endif
+         {
+            char message[256];
+
+            netx_get_error_message(errorno, message, 250, 0);
+            sprintf(pcon->error, "TCP Write Error: Cannot Write Data: Error Code: %d (%s)", errorno, message);
+         }
+         return -1;
+      }
+#if defined(NETX_ZEROCOPY)
+      if (flags & MSG_ZEROCOPY) {
+         pcon->zc_sent ++;
+      }
+#endif
+      sent += (unsigned int) n;
+      while (n > 0 && segn > 0) {
+         if ((size_t) n >= piov->iov_len) {
+            n -= (int) piov->iov_len;
+            piov ++;
+            segn --;
+         }
+         else {
+            piov->iov_base = (void *) ((char *) piov->iov_base + n);
+            piov->iov_len -= (size_t) n;
+            n = 0;
+         }
+      }
+   }
+#endif
+
+   return (int) total;
+}
+
+
+#if defined(NETX_ZEROCOPY)
+
+/* v2.1.20 Enable SO_ZEROCOPY on the socket the first time it is wanted */
+int netx_tcp_zerocopy(DBXCON *pcon)
 {
-   int result, n;
-   int len;
-   fd_set rset, eset;
-   struct timeval tval;
-   unsigned long spin_count;
+   int one;
+
+   if (pcon->zerocopy == 0) {
+      one = 1;
+      pcon->zerocopy = (NETX_SETSOCKOPT(pcon->cli_socket, SOL_SOCKET, SO_ZEROCOPY, (const char *) &one, sizeof(one)) == 0) ? 1 : -1;
+   }
 
+   return (pcon->zerocopy == 1);
+}
+
+
+/* v2.1.20 Read the completion notices for MSG_ZEROCOPY sends from the socket's error queue */
+int netx_tcp_zerocopy_reap(DBXCON *pcon, int timeout_ms)
+{
+   int n, waited;
+   char control[128];
+   struct msghdr msg;
+   struct cmsghdr *pcmsg;
+   struct sock_extended_err *perr;
+
+   waited = 0;
+   while (pcon->zc_done != pcon->zc_sent) {
+      memset((void *) &msg, 0, sizeof(msg));
+      msg.msg_control = (void *) control;
+      msg.msg_controllen = sizeof(control);
+      n = (int) recvmsg(pcon->cli_socket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+      if (n < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         /* poll() reports POLLERR while notices are queued */
+         if ((errno == EAGAIN || errno == EWOULDBLOCK) && !waited && netx_tcp_wait(pcon->cli_socket, 0, timeout_ms) > 0) {
+            waited = 1;
+            continue;
+         }
+         pcon->zc_done = pcon->zc_sent; /* the server has the data: the kernel has finished with it */
+         return -1;
+      }
+      waited = 0;
+      for (pcmsg = CMSG_FIRSTHDR(&msg); pcmsg; pcmsg = CMSG_NXTHDR(&msg, pcmsg)) {
+         if (!((pcmsg->cmsg_level == SOL_IP && pcmsg->cmsg_type == IP_RECVERR) || (pcmsg->cmsg_level == SOL_IPV6 && pcmsg->cmsg_type == IPV6_RECVERR))) {
+            continue;
+         }
+         perr = (struct sock_extended_err *) CMSG_DATA(pcmsg);
+         if (perr->ee_origin != SO_EE_ORIGIN_ZEROCOPY || perr->ee_errno != 0) {
+            continue;
+         }
+         pcon->zc_done = perr->ee_data + 1; /* sends ee_info to ee_data have completed */
+         if (perr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+            pcon->zc_copied ++;
+         }
+      }
+   }
+
+   return 0;
+}
+
+#endif
+
+
+
+/* v2.1.20 Read exactly 'size' bytes: bytes already buffered for the connection are used first, and the socket is only waited on when the buffer has run dry */
+/* v2.1.20 'context' is retained for compatibility: a read always returns the length requested (or an error) */
+int netx_tcp_read(DBXCON *pcon, unsigned char *data, int size, int timeout, int context)
+{
+   int n, len, avail;
 
    if (!pcon) {
       return NETX_READ_ERROR;
    }
 
-   result = 0;
-
-   tval.tv_sec = timeout;
-   tval.tv_usec = 0;
+   if (!pcon->rbuf) { /* released with the socket by netx_tcp_disconnect() */
+      pcon->rbuf = (unsigned char *) dbx_malloc(NETX_RECV_BUFFER, 901);
+      pcon->rbuf_pos = 0;
+      pcon->rbuf_len = 0;
+   }
 
-   spin_count = 0;
    len = 0;
-   for (;;) {
-      spin_count ++;
+   while (len < size) {
+      avail = pcon->rbuf_len - pcon->rbuf_pos;
+      if (avail > 0) {
+         n = (avail < (size - len)) ? avail : (size - len);
+         memcpy((void *) (data + len), (void *) (pcon->rbuf + pcon->rbuf_pos), (size_t) n);
+         pcon->rbuf_pos += n;
+         len += n;
+         continue;
+      }
+
+      /* the rest of a large block is read straight into the caller's buffer */
+      if (!pcon->rbuf || (size - len) >= NETX_RECV_BUFFER) {
+         n = netx_tcp_recv(pcon, data + len, size - len, timeout);
+         if (n < 1) {
+            return n;
+         }
+         len += n;
+         continue;
+      }
+
+      pcon->rbuf_pos = 0;
+      pcon->rbuf_len = 0;
+      n = netx_tcp_recv(pcon, pcon->rbuf, NETX_RECV_BUFFER, timeout);
+      if (n < 1) {
+         return n;
+      }
+      pcon->rbuf_len = n;
+   }
+
+   return len;
+}
 
+
+/* v2.1.20 Wait up to 'timeout' seconds (indefinitely if negative) for data, then take as much as the socket holds, up to 'size' bytes */
+int netx_tcp_recv(DBXCON *pcon, unsigned char *data, int size, int timeout)
+{
+   int n;
+#if defined(_WIN32)
+   fd_set rset, eset;
+   struct timeval tval;
+#endif
+
+   for (;;) {
+#if defined(_WIN32)
       FD_ZERO(&rset);
       FD_ZERO(&eset);
       FD_SET(pcon->cli_socket, &rset);
       FD_SET(pcon->cli_socket, &eset);
 
-      n = NETX_SELECT((int) (pcon->cli_socket + 1), &rset, NULL, &eset, &tval);
+      tval.tv_sec = timeout;
+      tval.tv_usec = 0;
+
+      n = NETX_SELECT((int) (pcon->cli_socket + 1), &rset, NULL, &eset, timeout < 0 ? NULL : &tval);
+      if (n > 0 && !NETX_FD_ISSET(pcon->cli_socket, &rset)) {
+         n = -1;
+      }
+#else
+      n = netx_tcp_wait(pcon->cli_socket, POLLIN, timeout < 0 ? -1 : timeout * 1000); /* v2.1.20 */
+#endif
 
       if (n == 0) {
          sprintf(pcon->error, "TCP Read Error: Server did not respond within the timeout period (%d seconds)", timeout);
-         result = NETX_READ_TIMEOUT;
-         break;
+         return NETX_READ_TIMEOUT;
       }
 
-      if (n < 0 || !NETX_FD_ISSET(pcon->cli_socket, &rset)) {
-          strcpy(pcon->error, "TCP Read Error: Server closed the connection without having returned any data");
-          result = NETX_READ_ERROR;
-         break;
+      if (n < 0) {
+         strcpy(pcon->error, "TCP Read Error: Server closed the connection without having returned any data");
+         pcon->net_connection = 0;
+         return NETX_READ_ERROR;
       }
 
-      n = NETX_RECV(pcon->cli_socket, (char *) data + len, size - len, 0);
-
-      if (n < 1) {
-         if (n == 0) {
-            result = NETX_READ_EOF;
-            pcon->net_connection = 0;
-            pcon->eof = 1;
-         }
-         else {
-            result = NETX_READ_ERROR;
-            len = 0;
-            pcon->net_connection = 0;
-         }
-         break;
+      n = NETX_RECV(pcon->cli_socket, (char *) data, size, 0);
+      if (n > 0) {
+         return n;
       }
-
-      len += n;
-      if (context) { /* Must read length requested */
-         if (len == size) {
-            break;
-         }
+#if !defined(_WIN32)
+      if (n < 0 && errno == EINTR) {
+         continue;
       }
-      else {
-         break;
+#endif
+      pcon->net_connection = 0;
+      if (n == 0) {
+         pcon->eof = 1;
+         return NETX_READ_EOF;
       }
+      return NETX_READ_ERROR;
    }
+}
 
-   if (len) {
-      result = len;
+
+#if !defined(_WIN32)
+/* v2.1.20 Wait up to 'timeout_ms' milliseconds (indefinitely if negative) for a socket to become ready: unlike select(), poll() works for descriptors above FD_SETSIZE and its cost does not grow with the highest descriptor in the process */
+/* v2.1.20 returns 1 if ready (or if the connection has failed, which the next call on the socket will report), 0 on timeout and -1 on error */
+int netx_tcp_wait(SOCKET sock, short events, int timeout_ms)
+{
+   int n;
+   struct pollfd pfd;
+
+   pfd.fd = (int) sock;
+   pfd.events = events;
+   pfd.revents = 0;
+
+   do {
+      n = NETX_POLL(&pfd, 1, timeout_ms);
+   } while (n < 0 && errno == EINTR);
+
+   if (n > 0) {
+      if (pfd.revents & POLLNVAL) {
+         return -1;
+      }
+      return 1;
    }
-   return result;
+   return n;
 }
+#endif
 
 
 
@@ -34,6 +34,13 @@
 #define NETX_READ_ERROR          -2
 #define NETX_READ_TIMEOUT        -3
 #define NETX_RECV_BUFFER         32768
+#define NETX_PIPE_SLOTS          256 /* v2.1.20 requests that may be in progress on a pipelined connection (a power of 2) */
+#define NETX_UV_SLOTS            1024 /* v2.1.20 the same for each connection of the event-loop transport (a power of 2) */
+
+#if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY) /* v2.1.20 */
+#define NETX_ZEROCOPY            1
+#include <linux/errqueue.h>
+#endif
 
 
 #if defined(LINUX)
@@ -160,6 +167,7 @@ typedef size_t          socklen_netx;
 #define NETX_GETSOCKOPT              getsockopt
 #define NETX_GETSOCKNAME             getsockname
 #define NETX_SELECT                  select
+#define NETX_POLL                    poll
 #define NETX_RECV                    recv
 #define NETX_SEND                    send
 #define NETX_SHUTDOWN                shutdown
@@ -385,14 +393,106 @@ typedef struct tagNETXSOCK {
 } NETXSOCK, *PNETXSOCK;
 
 
+/* v2.1.20 Pipelined connection (protocol revision 2): requests tagged with an ID are written back-to-back and a reader thread hands each response to the request waiting for it */
+#if !defined(_WIN32)
+typedef struct tagNETXPIPESLOT {
+   unsigned int      id;               /* 0: free */
+   DBXMETH           *pmeth;
+   short             done;
+   int               rc;
+   pthread_cond_t    cond;
+} NETXPIPESLOT, *PNETXPIPESLOT;
+
+typedef struct tagNETXPIPE {
+   DBXCON            *pcon;            /* the connection that owns the socket */
+   pthread_mutex_t   mutex;            /* the slots */
+   pthread_mutex_t   wmutex;           /* writes to the socket */
+   pthread_cond_t    cond_free;        /* a slot has been released */
+   pthread_t         reader;
+   unsigned int      next_id;
+   int               inflight;
+   int               inflight_peak;
+   short             closed;
+   unsigned long long requests;
+   NETXPIPESLOT      slot[NETX_PIPE_SLOTS];
+} NETXPIPE, *PNETXPIPE;
+
+/* v2.1.20 Event-loop transport: each connection (protocol revision 2) is watched by a uv_poll_t, requests are written without blocking and responses are read as they arrive, all on the primary thread */
+typedef struct tagNETXUVCON {
+   struct tagNETXUV  *puv;
+   DBXCON            *pcon;            /* the connection's own socket (non-blocking) */
+   uv_poll_t         poll;
+   int               events;
+   short             closed;
+   short             want_write;       /* the socket would not take any more */
+   DBXMETH           *wq_head;         /* requests still to be written: the first may be partly written */
+   DBXMETH           *wq_tail;
+   unsigned int      next_id;
+   int               inflight;         /* requests holding a slot */
+   int               load;             /* requests not yet answered */
+   unsigned char     head[9];          /* the response being read: request ID and block header */
+   int               head_got;
+   DBXMETH           *pread;
+   int               body_len;
+   int               body_got;
+   short             discard;
+   DBXMETH           *slot[NETX_UV_SLOTS];
+} NETXUVCON, *PNETXUVCON;
+
+typedef struct tagNETXUV {
+   int               size;
+   int               handles;          /* uv_poll_t handles not yet closed */
+   short             closing;
+   int               inflight_peak;
+   unsigned long long requests;
+   unsigned long     lost;
+   NETXUVCON         *con;
+   struct pollfd     *pfd;
+} NETXUV, *PNETXUV;
+#endif
+
+
 int                     netx_load_winsock             (DBXCON *pcon, int context);
 int                     netx_tcp_connect              (DBXCON *pcon, int context);
 int                     netx_tcp_handshake            (DBXCON *pcon, int context);
 int                     netx_tcp_command              (DBXMETH *pmeth, int command, int context);
 int                     netx_tcp_connect_ex           (DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_addr_len, int timeout);
 int                     netx_tcp_disconnect           (DBXCON *pcon, int context);
+int                     netx_tcp_alive                (DBXCON *pcon, int context);
 int                     netx_tcp_write                (DBXCON *pcon, unsigned char *data, int size);
+int                     netx_tcp_writev               (DBXCON *pcon, DBXMETH *pmeth, unsigned char *netbuf, unsigned int netbuf_used, int context);
+#if defined(NETX_ZEROCOPY)
+int                     netx_tcp_zerocopy             (DBXCON *pcon);
+int                     netx_tcp_zerocopy_reap        (DBXCON *pcon, int timeout_ms);
+#endif
 int                     netx_tcp_read                 (DBXCON *pcon, unsigned char *data, int size, int timeout, int context);
+int                     netx_tcp_recv                 (DBXCON *pcon, unsigned char *data, int size, int timeout);
+#if !defined(_WIN32)
+int                     netx_tcp_wait                 (SOCKET sock, short events, int timeout_ms);
+#endif
+int                     netx_tcp_discard              (DBXCON *pcon, unsigned char *buffer, int buffer_size, int len);
+int                     netx_tcp_result               (DBXMETH *pmeth, int len);
+#if !defined(_WIN32)
+int                     netx_pipe_open                (DBXCON *pcon);
+int                     netx_pipe_close               (DBXCON *pcon);
+int                     netx_pipe_command             (DBXMETH *pmeth, int command, int context);
+void *                  netx_pipe_reader              (void *data);
+int                     netx_uv_open                  (DBXCON *pcon, uv_loop_t *loop);
+int                     netx_uv_close                 (DBXCON *pcon);
+int                     netx_uv_command               (DBXMETH *pmeth, int command);
+int                     netx_uv_service               (NETXUV *puv, int timeout_ms);
+int                     netx_uv_load                  (NETXUV *puv);
+void                    netx_uv_close_callback        (uv_handle_t *handle);
+void                    netx_uv_poll_callback         (uv_poll_t *handle, int status, int events);
+void                    netx_uv_io                    (NETXUVCON *pconn, int readable, int writable);
+void                    netx_uv_events                (NETXUVCON *pconn);
+int                     netx_uv_write                 (NETXUVCON *pconn);
+int                     netx_uv_read                  (NETXUVCON *pconn);
+void                    netx_uv_header                (NETXUVCON *pconn);
+void                    netx_uv_response              (NETXUVCON *pconn);
+void                    netx_uv_complete              (NETXUVCON *pconn, DBXMETH *pmeth);
+void                    netx_uv_lost                  (NETXUVCON *pconn);
+#endif
 int                     netx_get_last_error           (int context);
 int                     netx_get_error_message        (int error_code, char *message, int size, int context);
 int                     netx_get_std_error_message    (int error_code, char *message, int size, int context);
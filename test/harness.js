@@ -0,0 +1,62 @@
+//
+//   ----------------------------------------------------------------------------
+//   | Package:     mg-dbx                                                      |
+//   | OS:          Unix/Windows                                                |
+//   | Description: Helpers shared by the tests                                 |
+//   ----------------------------------------------------------------------------
+//
+// The addon under test is build/Release/mg-dbx.node unless the MG_DBX_NODE
+// environment variable names another build.
+//
+
+"use strict";
+
+const path = require('path');
+const MockServer = require('./mock-dbx1.js');
+
+const dbx = require(process.env.MG_DBX_NODE || path.join(__dirname, '..', 'build', 'Release', 'mg-dbx.node'));
+
+// The ways in which asynchronous requests reach the server
+const transports = {
+   threads: {pool_size: 4},
+   uv: {pool_size: 2, transport: 'uv'},
+   pipeline: {pool_size: 4, pipeline: true}
+};
+
+// Start a mock server and open a connection to it
+async function connect(options, mock_options) {
+   const mock = await MockServer.spawn(mock_options);
+   const db = new dbx.dbx();
+
+   db.open(Object.assign({type: 'YottaDB', host: '127.0.0.1', tcp_port: mock.port}, options || {}));
+   return {
+      db: db,
+      mock: mock,
+      close: () => {
+         db.close();
+         mock.close();
+      }
+   };
+}
+
+// Settle a Promise as ['ok', value] or ['error', message]
+function settle(promise) {
+   return promise.then((value) => ['ok', value], (error) => ['error', error.message]);
+}
+
+// Call an asynchronous method with a callback and resolve with [error, result]
+function callback(object, method) {
+   const args = Array.prototype.slice.call(arguments, 2);
+
+   return new Promise((resolve) => {
+      object[method].apply(object, args.concat([(error, result) => resolve([error, result])]));
+   });
+}
+
+module.exports = {
+   dbx: dbx,
+   transports: transports,
+   connect: connect,
+   settle: settle,
+   callback: callback
+};
@@ -0,0 +1,336 @@
+//
+//   ----------------------------------------------------------------------------
+//   | Package:     mg-dbx                                                      |
+//   | OS:          Unix/Windows                                                |
+//   | Description: A mock dbx1 server (dbxnet^%zmgsis) for the tests           |
+//   ----------------------------------------------------------------------------
+//
+// Globals are held in memory.  Revision 2 of the protocol is offered to
+// clients that ask for it, and the extrinsic functions of routine "mock" control
+// the timing and outcome of responses:
+//
+//   $$delay^mock(ms,value)  reply with value after ms milliseconds
+//   $$error^mock(text)      reply with an error
+//   $$size^mock(n)          reply with a value of n bytes (the last is 'z'), larger
+//                           values are written in pieces as the socket drains
+//   $$drop^mock()           close the connection without replying
+//   $$stray^mock(value)     reply with value, after a response bearing an ID
+//                           that no request is waiting for (revision 2)
+//   $$stats^mock()          reply with the server's counters (JSON)
+//
+// The option {latency: ms} delays the handling of every request by ms
+// milliseconds, as a server at the far end of a network link would.
+//
+// Synchronous calls block the event loop so the server is run in a child
+// process: MockServer.spawn() starts one and resolves with its port.
+//
+
+"use strict";
+
+const net = require('net');
+
+const DSORT_DATA = 1;
+const DSORT_EOD = 9;
+const DSORT_ERROR = 11;
+const DTYPE_STR = 1;
+const STREAM_CHUNK = 1048576;
+
+// M collation: canonical numbers first, in numeric order, then strings
+function collate(a, b) {
+   const canonic = /^-?(0|[1-9][0-9]*)(\.[0-9]*[1-9])?$|^-?\.[0-9]*[1-9]$/;
+   const an = canonic.test(a), bn = canonic.test(b);
+
+   if (an && bn) {
+      return parseFloat(a) - parseFloat(b);
+   }
+   if (an !== bn) {
+      return an ? -1 : 1;
+   }
+   return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+function head(len, sort, type) {
+   const b = Buffer.alloc(5);
+   b.writeUInt32LE(len, 0);
+   b[4] = (sort * 20) + type;
+   return b;
+}
+
+class MockServer {
+   constructor(options) {
+      options = options || {};
+      this.revision = options.revision || 2; // the highest revision offered
+      this.latency = options.latency || 0;
+      this.globals = new Map();
+      this.requests = 0;
+      this.max_pending = 0;
+      this.sockets = new Set();
+      this.server = net.createServer((socket) => this.connection(socket));
+   }
+
+   listen() {
+      return new Promise((resolve) => {
+         this.server.listen(0, '127.0.0.1', () => {
+            this.port = this.server.address().port;
+            resolve(this.port);
+         });
+      });
+   }
+
+   close() {
+      for (const socket of this.sockets) {
+         socket.destroy();
+      }
+      return new Promise((resolve) => this.server.close(() => resolve()));
+   }
+
+   connection(socket) {
+      const con = {socket: socket, buf: Buffer.alloc(0), rev: 0, pending: 0, streaming: false, held: []};
+
+      this.sockets.add(socket);
+      socket.setNoDelay(true);
+      socket.on('close', () => this.sockets.delete(socket));
+      socket.on('error', () => {});
+      socket.on('data', (data) => {
+         con.buf = Buffer.concat([con.buf, data]);
+         this.service(con);
+      });
+   }
+
+   service(con) {
+      while (true) {
+         if (con.rev === 0) {
+            const eol = con.buf.indexOf(10);
+            if (eol < 0) {
+               return;
+            }
+            const piece = con.buf.slice(0, eol).toString().split('~');
+            con.buf = con.buf.slice(eol + 1);
+            con.rev = (piece[2] === '2' && this.revision >= 2) ? 2 : 1;
+            const zv = Buffer.from('GT.M V6.3-008 Linux x86_64');
+            const reply = head(zv.length, 0, 0);
+            reply[4] = (con.rev === 2) ? 0x32 : 0x30;
+            con.socket.write(Buffer.concat([reply, zv]));
+            continue;
+         }
+         if (con.buf.length < 5) {
+            return;
+         }
+         const len = con.buf.readUInt32LE(0);
+         if (con.buf.length < len) {
+            return;
+         }
+         const frame = con.buf.slice(0, len);
+         con.buf = con.buf.slice(len);
+         this.request(con, frame);
+      }
+   }
+
+   request(con, frame) {
+      const cmnd = frame[4];
+      const id = frame.readUInt32LE(10);
+      const args = [];
+      let offset = 15;
+
+      while (offset + 5 <= frame.length) {
+         const alen = frame.readUInt32LE(offset);
+         const sort = Math.floor(frame[offset + 4] / 20);
+         if (sort === DSORT_EOD) {
+            break;
+         }
+         args.push(frame.slice(offset + 5, offset + 5 + alen));
+         offset += 5 + alen;
+      }
+
+      this.requests ++;
+      con.pending ++;
+      if (con.pending > this.max_pending) {
+         this.max_pending = con.pending;
+      }
+
+      // data may be a number: that many bytes of 'x' (the last is 'z') written in pieces
+      const reply = (sort, data) => {
+         con.pending --;
+         if (con.socket.destroyed) {
+            return;
+         }
+         if (typeof data !== 'number') {
+            this.send(con, this.frame(con, id, sort, data));
+            return;
+         }
+         this.send(con, this.frame(con, id, sort, null, data), data);
+      };
+      reply.id = id;
+
+      if (this.latency) {
+         setTimeout(() => this.execute(con, cmnd, args, reply), this.latency);
+         return;
+      }
+      this.execute(con, cmnd, args, reply);
+   }
+
+   execute(con, cmnd, args, reply) {
+      const key = args.map((a) => a.toString('latin1'));
+      if (cmnd !== 31 && key.length && key[0][0] === '^') {
+         key[0] = key[0].slice(1); // ^Person and Person name the same global
+      }
+      const str = (s) => Buffer.from(String(s), 'latin1');
+
+      switch (cmnd) {
+         case 11: { // set
+            const value = args[args.length - 1];
+            this.globals.set(JSON.stringify(key.slice(0, -1)), Buffer.from(value));
+            return reply(DSORT_DATA, str('0'));
+         }
+         case 12: { // get
+            const value = this.globals.get(JSON.stringify(key));
+            return reply(DSORT_DATA, value || str(''));
+         }
+         case 13: // $order
+         case 14:
+         case 131: // $order and the data at the node found
+         case 141: {
+            const found = this.order(key, (cmnd === 13 || cmnd === 131) ? 1 : -1);
+            if (cmnd === 13 || cmnd === 14) {
+               return reply(DSORT_DATA, str(found));
+            }
+            const data = (found !== '' && this.globals.get(JSON.stringify(key.slice(0, -1).concat(found)))) || str('');
+            return reply(DSORT_DATA, Buffer.concat([head(found.length, DSORT_DATA, DTYPE_STR), str(found), head(data.length, DSORT_DATA, DTYPE_STR), data]));
+         }
+         case 15: // kill
+            this.globals.delete(JSON.stringify(key));
+            return reply(DSORT_DATA, str('0'));
+         case 16: // $data
+            return reply(DSORT_DATA, str(this.globals.has(JSON.stringify(key)) ? '1' : '0'));
+         case 31: // extrinsic function
+            return this.fun(con, key, reply);
+         default:
+            return reply(DSORT_ERROR, str('<SYNTAX>'));
+      }
+   }
+
+   // a response: the request ID (revision 2), the block header and the data (unless it is to be streamed)
+   frame(con, id, sort, data, length) {
+      const parts = [head(data ? data.length : length, sort, DTYPE_STR)];
+
+      if (con.rev === 2) {
+         const prefix = Buffer.alloc(4);
+         prefix.writeUInt32LE(id, 0);
+         parts.unshift(prefix);
+      }
+      if (data) {
+         parts.push(data);
+      }
+      return Buffer.concat(parts);
+   }
+
+   // write a response, followed by a streamed value of length bytes: others wait until it has been written
+   send(con, data, length) {
+      if (con.streaming) {
+         con.held.push([data, length]);
+         return;
+      }
+      con.socket.write(data);
+      if (!length) {
+         return;
+      }
+
+      const chunk = Buffer.alloc(STREAM_CHUNK, 'x');
+      let left = length;
+      const write = () => {
+         while (left > 0 && !con.socket.destroyed) {
+            let piece = chunk;
+            if (left <= chunk.length) {
+               piece = Buffer.alloc(left, 'x');
+               piece[left - 1] = 0x7a;
+            }
+            left -= piece.length;
+            if (!con.socket.write(piece)) {
+               con.socket.once('drain', write);
+               return;
+            }
+         }
+         con.streaming = false;
+         while (con.held.length && !con.streaming) {
+            const next = con.held.shift();
+            this.send(con, next[0], next[1]);
+         }
+      };
+      con.streaming = true;
+      write();
+   }
+
+   order(key, dir) {
+      const prefix = key.slice(0, -1);
+      const seed = key[key.length - 1];
+      let found = '';
+
+      for (const stored of this.globals.keys()) {
+         const k = JSON.parse(stored);
+         if (k.length <= prefix.length || prefix.some((p, i) => p !== k[i])) {
+            continue;
+         }
+         const sub = k[prefix.length];
+         if (seed !== '' && collate(sub, seed) * dir <= 0) {
+            continue;
+         }
+         if (found === '' || collate(sub, found) * dir < 0) {
+            found = sub;
+         }
+      }
+      return found;
+   }
+
+   fun(con, key, reply) {
+      const name = key[0];
+      const str = (s) => Buffer.from(String(s), 'latin1');
+
+      if (name === 'delay^mock') {
+         setTimeout(() => reply(DSORT_DATA, str(key[2])), parseInt(key[1], 10));
+      }
+      else if (name === 'error^mock') {
+         reply(DSORT_ERROR, str(key[1]));
+      }
+      else if (name === 'size^mock') {
+         const size = parseInt(key[1], 10);
+         if (size > STREAM_CHUNK) {
+            return reply(DSORT_DATA, size);
+         }
+         const data = Buffer.alloc(size, 'x');
+         data[data.length - 1] = 0x7a;
+         reply(DSORT_DATA, data);
+      }
+      else if (name === 'drop^mock') {
+         con.socket.destroy();
+      }
+      else if (name === 'stray^mock') {
+         // the same slot as this request's ID in the client's table (its size is a power of 2 no larger than 65536)
+         this.send(con, this.frame(con, (reply.id + 0x10000) >>> 0, DSORT_DATA, str('stray')));
+         reply(DSORT_DATA, str(key[1]));
+      }
+      else if (name === 'stats^mock') {
+         reply(DSORT_DATA, str(JSON.stringify({requests: this.requests, max_pending: this.max_pending})));
+      }
+      else {
+         reply(DSORT_ERROR, str('<NOROUTINE>'));
+      }
+   }
+}
+
+MockServer.spawn = function (options) {
+   const child_process = require('child_process');
+   const child = child_process.fork(__filename, [JSON.stringify(options || {})], {stdio: ['ignore', 'inherit', 'inherit', 'ipc']});
+
+   return new Promise((resolve, reject) => {
+      child.once('message', (port) => resolve({port: port, child: child, close: () => child.kill()}));
+      child.once('error', reject);
+   });
+};
+
+if (require.main === module) {
+   const mock = new MockServer(JSON.parse(process.argv[2] || '{}'));
+   mock.listen().then((port) => process.send(port));
+   process.on('disconnect', () => process.exit(0));
+}
+
+module.exports = MockServer;
@@ -0,0 +1,54 @@
+//
+//   ----------------------------------------------------------------------------
+//   | Package:     mg-dbx                                                      |
+//   | OS:          Unix/Windows                                                |
+//   | Description: Run the tests (npm test)                                    |
+//   ----------------------------------------------------------------------------
+//
+// Each test-*.js file exports an object of named async functions.  Name files
+// on the command line to run only those.
+//
+
+"use strict";
+
+const fs = require('fs');
+const path = require('path');
+
+const TIMEOUT = 60000;
+
+async function main() {
+   let files = process.argv.slice(2);
+   let passed = 0, failed = 0;
+
+   if (!files.length) {
+      files = fs.readdirSync(__dirname).filter((file) => /^test-.*\.js$/.test(file)).sort();
+   }
+
+   for (const file of files) {
+      const tests = require(path.resolve(__dirname, path.basename(file)));
+
+      for (const name of Object.keys(tests)) {
+         let timer;
+         const timeout = new Promise((resolve, reject) => {
+            timer = setTimeout(() => reject(new Error('timed out after ' + TIMEOUT + 'ms')), TIMEOUT);
+         });
+
+         try {
+            await Promise.race([tests[name](), timeout]);
+            passed ++;
+            console.log('ok - ' + path.basename(file, '.js') + ': ' + name);
+         }
+         catch (error) {
+            failed ++;
+            console.log('not ok - ' + path.basename(file, '.js') + ': ' + name);
+            console.log('   ' + (error && error.stack ? error.stack : error).toString().split('\n').join('\n   '));
+         }
+         clearTimeout(timer);
+      }
+   }
+
+   console.log('\n' + passed + ' passed, ' + failed + ' failed');
+   process.exit(failed ? 1 : 0);
+}
+
+main();
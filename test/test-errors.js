@@ -0,0 +1,126 @@
+//
+//   ----------------------------------------------------------------------------
+//   | Package:     mg-dbx                                                      |
+//   | OS:          Unix/Windows                                                |
+//   | Description: An error belongs to the request that raised it              |
+//   ----------------------------------------------------------------------------
+//
+
+"use strict";
+
+const assert = require('assert');
+const harness = require('./harness.js');
+
+const tests = {};
+
+for (const transport of Object.keys(harness.transports)) {
+   tests['a rejected Promise leaves concurrent requests alone (' + transport + ')'] = async function () {
+      const con = await harness.connect(harness.transports[transport]);
+
+      try {
+         const person = new harness.dbx.mglobal(con.db, 'Person');
+         const requests = [];
+
+         person.set(1, 'John Smith');
+         for (let n = 0; n < 8; n ++) {
+            requests.push(harness.settle(person.getAsync(1)));
+            if (n === 3) {
+               requests.push(harness.settle(con.db.functionAsync('error^mock', 'boom')));
+            }
+         }
+         const results = await Promise.all(requests);
+
+         assert.deepStrictEqual(results[4], ['error', 'boom']);
+         results.splice(4, 1);
+         for (const result of results) {
+            assert.deepStrictEqual(result, ['ok', 'John Smith']);
+         }
+
+         // the error does not stick to the connection
+         assert.deepStrictEqual(await harness.settle(person.getAsync(1)), ['ok', 'John Smith']);
+      }
+      finally {
+         con.close();
+      }
+   };
+
+   tests['a callback receives only its own error (' + transport + ')'] = async function () {
+      const con = await harness.connect(harness.transports[transport]);
+
+      try {
+         const person = new harness.dbx.mglobal(con.db, 'Person');
+         const requests = [];
+
+         person.set(1, 'John Smith');
+         requests.push(harness.callback(con.db, 'function', 'error^mock', 'boom'));
+         for (let n = 0; n < 8; n ++) {
+            requests.push(harness.callback(person, 'get', 1));
+         }
+         const results = await Promise.all(requests);
+
+         assert.ok(results[0][0], 'the failing request reports an error');
+         for (const result of results.slice(1)) {
+            assert.deepStrictEqual(result, [0, 'John Smith']);
+         }
+      }
+      finally {
+         con.close();
+      }
+   };
+}
+
+// the connection's only thread for asynchronous requests shares it with the main thread
+tests['synchronous and asynchronous requests on one connection keep their own errors (pool_size 1)'] = async function () {
+   const con = await harness.connect({pool_size: 1});
+
+   try {
+      const person = new harness.dbx.mglobal(con.db, 'Person');
+
+      person.set(1, 'John Smith');
+      for (let n = 0; n < 50; n ++) {
+         const failing = harness.settle(con.db.functionAsync('error^mock', 'async ' + n));
+         const reading = harness.settle(person.getAsync(1));
+
+         assert.strictEqual(con.db.function('error^mock', 'sync ' + n), '');
+         assert.strictEqual(person.get(1), 'John Smith');
+         assert.deepStrictEqual(await Promise.all([failing, reading]), [['error', 'async ' + n], ['ok', 'John Smith']]);
+      }
+   }
+   finally {
+      con.close();
+   }
+};
+
+// the fixed subscripts of an mglobal object count towards the argument limit
+tests['subscripts beyond the argument limit are refused'] = async function () {
+   const con = await harness.connect(harness.transports.threads);
+
+   try {
+      const keys = [];
+      for (let n = 0; n < 60; n ++) {
+         keys.push('k' + n);
+      }
+      const wide = new harness.dbx.mglobal(con.db, 'Wide', ...keys);
+
+      wide.set(1, 2, 'v3');
+      assert.strictEqual(wide.get(1, 2), 'v3');
+      assert.throws(() => wide.get(1, 2, 3, 4), {message: 'Too many arguments on Get'});
+      assert.throws(() => wide.set(1, 2, 3, 'v5'), {message: 'Too many arguments on Set'});
+      assert.throws(() => wide.getAsync(1, 2, 3, 4), {message: 'Too many arguments on Get'}); // argument errors are raised before a request is queued
+
+      // a recycled request block does not carry the wide request's arguments into the next one
+      const subscripts = [];
+      for (let n = 0; n < 20; n ++) {
+         subscripts.push(n);
+      }
+      await Promise.all([1, 2, 3, 4].map((n) => con.db.setAsync('X', ...subscripts, 'wide ' + n)));
+      con.db.set('X', 1, 'one');
+      assert.deepStrictEqual(await Promise.all([1, 2, 3, 4].map(() => con.db.getAsync('X', 1))), ['one', 'one', 'one', 'one']);
+      assert.strictEqual(await con.db.getAsync('X', ...subscripts), 'wide 4');
+   }
+   finally {
+      con.close();
+   }
+};
+
+module.exports = tests;
@@ -0,0 +1,149 @@
+//
+//   ----------------------------------------------------------------------------
+//   | Package:     mg-dbx                                                      |
+//   | OS:          Unix/Windows                                                |
+//   | Description: Values larger than the initial output buffer (32000 bytes)  |
+//   ----------------------------------------------------------------------------
+//
+
+"use strict";
+
+const assert = require('assert');
+const harness = require('./harness.js');
+
+const MB = 1048576;
+
+// n bytes of 'x' ending with 'z' (the values returned by $$size^mock)
+function check(value, n) {
+   assert.strictEqual(value.length, n);
+   if (n) {
+      assert.strictEqual(value[n - 1], Buffer.isBuffer(value) ? 0x7a : 'z');
+      assert.strictEqual(value[0], Buffer.isBuffer(value) ? 0x78 : (n > 1 ? 'x' : 'z'));
+   }
+}
+
+const tests = {};
+
+// runs first: the high-water mark of the buffer growth tag is process-wide
+tests['the output buffer grows to the next power of two'] = async function () {
+   const con = await harness.connect();
+
+   try {
+      const stats = () => con.db.memstats().allocator.tags.ibuffer || {allocs: 0, bytes: 0, bytes_peak: 0};
+      const before = stats();
+
+      // each is above the size that a request block keeps when it is released, so a buffer is held only while its response is read
+      for (const n of [200000, 300000, 3 * MB, 5 * MB]) {
+         let size = 32768;
+         while (size < n + 32) {
+            size *= 2;
+         }
+         check(con.db.function('size^mock', n), n);
+         assert.strictEqual(stats().bytes_peak, before.bytes + size);
+      }
+      // one allocation for each response however large: the buffer is sized from the framed length
+      assert.strictEqual(stats().allocs - before.allocs, 4);
+   }
+   finally {
+      con.close();
+   }
+};
+
+tests['responses either side of the initial buffer size'] = async function () {
+   const con = await harness.connect();
+
+   try {
+      for (const n of [0, 1, 31967, 31968, 32000, 32001, 32736, 32737, 65536, 65537, 3 * MB + 1]) {
+         check(con.db.function('size^mock', n), n);
+      }
+      check(con.db.function('size^mock', 10), 10); // a small value after a large one
+   }
+   finally {
+      con.close();
+   }
+};
+
+tests['multi-megabyte values through set, get and get_bx'] = async function () {
+   const con = await harness.connect();
+
+   try {
+      const doc = new harness.dbx.mglobal(con.db, 'Doc');
+      const value = 'y'.repeat(5 * MB - 1) + 'z';
+
+      doc.set(1, value);
+      doc.set(2, 'small');
+      assert.strictEqual(doc.get(1), value);
+      assert.strictEqual(doc.get(2), 'small');
+      const bx = doc.get_bx(1);
+      assert.ok(Buffer.isBuffer(bx));
+      assert.strictEqual(bx.length, value.length);
+      assert.strictEqual(bx.toString(), value);
+      assert.strictEqual(doc.get(2), 'small');
+   }
+   finally {
+      con.close();
+   }
+};
+
+// a small result after a large one is copied: V8 is not handed the grown output buffer for a few bytes
+tests['a small get_bx after a large get'] = async function () {
+   const con = await harness.connect();
+
+   try {
+      const stats = () => con.db.memstats().allocator.tags;
+      const doc = new harness.dbx.mglobal(con.db, 'Doc');
+      const value = 'y'.repeat(60000);
+
+      doc.set(1, value);
+      doc.set(2, 'small');
+      assert.strictEqual(doc.get(1), value); // grows the output buffer to 65536 bytes, which the request block keeps
+      const before = stats();
+      const bx = doc.get_bx(2);
+      const after = stats();
+
+      assert.ok(Buffer.isBuffer(bx));
+      assert.strictEqual(bx.toString(), 'small');
+      assert.strictEqual(after.ibuffer.bytes, before.ibuffer.bytes);
+      assert.strictEqual(after.request.allocs, before.request.allocs);
+      assert.strictEqual(doc.get_bx(1).toString(), value);
+      assert.strictEqual(doc.get_bx(2).toString(), 'small');
+   }
+   finally {
+      con.close();
+   }
+};
+
+for (const transport of Object.keys(harness.transports)) {
+   tests['concurrent multi-megabyte responses (' + transport + ')'] = async function () {
+      const con = await harness.connect(harness.transports[transport]);
+
+      try {
+         const sizes = [4 * MB, 100, 2 * MB + 3, 32001, 6 * MB, 0, 40000, MB];
+         const results = await Promise.all(sizes.map((n) => con.db.functionAsync('size^mock', n)));
+
+         results.forEach((value, i) => check(value, sizes[i]));
+         check(await con.db.functionAsync('size^mock', 5), 5);
+      }
+      finally {
+         con.close();
+      }
+   };
+
+   // a response that cannot be stored is read and discarded so that the next request is unaffected
+   tests['a response too large to store (' + transport + ')'] = async function () {
+      const con = await harness.connect(harness.transports[transport]);
+
+      try {
+         const result = await harness.settle(con.db.functionAsync('size^mock', 1100 * MB));
+
+         assert.deepStrictEqual(result, ['error', 'Unable to allocate memory for the response']);
+         check(await con.db.functionAsync('size^mock', 3 * MB), 3 * MB);
+         check(con.db.function('size^mock', 7), 7);
+      }
+      finally {
+         con.close();
+      }
+   };
+}
+
+module.exports = tests;
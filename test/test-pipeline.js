@@ -0,0 +1,161 @@
+//
+//   ----------------------------------------------------------------------------
+//   | Package:     mg-dbx                                                      |
+//   | OS:          Unix/Windows                                                |
+//   | Description: Pipelined connections (revision 2 of the protocol)          |
+//   ----------------------------------------------------------------------------
+//
+
+"use strict";
+
+const assert = require('assert');
+const fs = require('fs');
+const harness = require('./harness.js');
+
+// functions run on the long lane: let every thread take them so that they are all in progress together
+const pipeline = Object.assign({}, harness.transports.pipeline, {long_threads: harness.transports.pipeline.pool_size});
+
+function threads() {
+   return fs.readdirSync('/proc/self/task').length;
+}
+
+const tests = {};
+
+tests['responses returned out of order reach their own requests'] = async function () {
+   const con = await harness.connect(pipeline);
+
+   try {
+      const delays = [300, 200, 100, 0];
+      const order = [];
+      const results = await Promise.all(delays.map((ms, n) => {
+         return con.db.functionAsync('delay^mock', ms, 'r' + n).then((value) => {
+            order.push(n);
+            return value;
+         });
+      }));
+
+      assert.deepStrictEqual(results, ['r0', 'r1', 'r2', 'r3']);
+      assert.deepStrictEqual(order, [3, 2, 1, 0], 'the fastest responses complete first');
+
+      // every request was in progress on the one connection at the same time
+      const stats = JSON.parse(con.db.function('stats^mock'));
+      assert.ok(stats.max_pending >= 4, 'max_pending: ' + stats.max_pending);
+      assert.ok(con.db.poolstats().pipeline.inflight_peak >= 4);
+   }
+   finally {
+      con.close();
+   }
+};
+
+// more requests than the connections have slots for (NETX_PIPE_SLOTS each): slots are reused while other requests are in progress
+tests['many requests in progress each receive their own response'] = async function () {
+   const con = await harness.connect(pipeline);
+
+   try {
+      const person = new harness.dbx.mglobal(con.db, 'Person');
+      const requests = [];
+
+      for (let n = 0; n < 2000; n ++) {
+         person.set(n, 'name ' + n);
+      }
+      const sent = con.db.poolstats().pipeline.requests;
+      for (let n = 0; n < 2000; n ++) {
+         requests.push((n % 10) ? person.getAsync(n) : con.db.functionAsync('delay^mock', n % 7, 'name ' + n));
+      }
+      const results = await Promise.all(requests);
+
+      results.forEach((value, n) => assert.strictEqual(value, 'name ' + n));
+      assert.strictEqual(con.db.poolstats().pipeline.requests - sent, 2000);
+      assert.strictEqual(con.db.poolstats().pipeline.inflight, 0);
+   }
+   finally {
+      con.close();
+   }
+};
+
+tests['a synchronous request overtakes asynchronous ones in progress'] = async function () {
+   const con = await harness.connect(pipeline);
+
+   try {
+      const person = new harness.dbx.mglobal(con.db, 'Person');
+      const slow = con.db.functionAsync('delay^mock', 300, 'slow');
+
+      person.set(1, 'John Smith');
+      assert.strictEqual(person.get(1), 'John Smith');
+      assert.strictEqual(await slow, 'slow');
+   }
+   finally {
+      con.close();
+   }
+};
+
+for (const transport of ['pipeline', 'uv']) {
+   tests['a response for a request ID not in progress is discarded (' + transport + ')'] = async function () {
+      const con = await harness.connect(harness.transports[transport]);
+
+      try {
+         const results = await Promise.all([0, 1, 2, 3].map((n) => con.db.functionAsync('stray^mock', 'v' + n)));
+
+         assert.deepStrictEqual(results, ['v0', 'v1', 'v2', 'v3']);
+         assert.strictEqual(await con.db.functionAsync('delay^mock', 0, 'after'), 'after');
+      }
+      finally {
+         con.close();
+      }
+   };
+}
+
+tests['a lost connection fails the requests in progress'] = async function () {
+   const con = await harness.connect(pipeline);
+
+   try {
+      const waiting = [0, 1, 2].map((n) => harness.settle(con.db.functionAsync('delay^mock', 2000, 'r' + n)));
+      const dropped = harness.settle(con.db.functionAsync('drop^mock'));
+      const lost = ['error', 'Connection to the server lost'];
+
+      assert.deepStrictEqual(await dropped, lost);
+      assert.deepStrictEqual(await Promise.all(waiting), [lost, lost, lost]);
+      assert.deepStrictEqual(await harness.settle(con.db.functionAsync('delay^mock', 0, 'later')), lost);
+      assert.strictEqual(con.db.poolstats().pipeline.closed, true);
+   }
+   finally {
+      con.close();
+   }
+};
+
+if (fs.existsSync('/proc/self/task')) {
+   tests['closing a connection stops its reader thread'] = async function () {
+      const before = threads();
+
+      for (let n = 0; n < 5; n ++) {
+         const con = await harness.connect(pipeline);
+
+         assert.strictEqual(await con.db.functionAsync('delay^mock', 0, 'v' + n), 'v' + n);
+         assert.ok(threads() > before);
+         con.close();
+         assert.strictEqual(threads(), before);
+      }
+
+      // the reader thread also stops when the server has gone
+      const con = await harness.connect(pipeline);
+      await harness.settle(con.db.functionAsync('drop^mock'));
+      con.close();
+      assert.strictEqual(threads(), before);
+   };
+}
+
+tests['a server without revision 2 is used one request at a time'] = async function () {
+   const con = await harness.connect(pipeline, {revision: 1});
+
+   try {
+      const results = await Promise.all([200, 100, 0].map((ms, n) => con.db.functionAsync('delay^mock', ms, 'r' + n)));
+
+      assert.deepStrictEqual(results, ['r0', 'r1', 'r2']);
+      assert.strictEqual(con.db.poolstats().pipeline, undefined);
+   }
+   finally {
+      con.close();
+   }
+};
+
+module.exports = tests;
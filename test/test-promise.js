@@ -0,0 +1,110 @@
+//
+//   ----------------------------------------------------------------------------
+//   | Package:     mg-dbx                                                      |
+//   | OS:          Unix/Windows                                                |
+//   | Description: The Promise returning (Async) methods                       |
+//   ----------------------------------------------------------------------------
+//
+
+"use strict";
+
+const assert = require('assert');
+const harness = require('./harness.js');
+
+const tests = {};
+
+tests['the Async methods resolve with the result of the synchronous method'] = async function () {
+   const con = await harness.connect(harness.transports.threads);
+
+   try {
+      const db = con.db;
+      const person = new harness.dbx.mglobal(db, 'Person');
+
+      assert.ok(db.setAsync('Person', 1, 'John Smith') instanceof Promise);
+      await db.setAsync('Person', 1, 'John Smith');
+      assert.strictEqual(await db.getAsync('Person', 1), db.get('Person', 1));
+      assert.strictEqual(await db.getAsync('Person', 1), 'John Smith');
+      assert.strictEqual(await db.definedAsync('Person', 1), db.defined('Person', 1));
+      assert.strictEqual(await db.nextAsync('Person', ''), db.next('Person', ''));
+      assert.strictEqual(await db.previousAsync('Person', ''), db.previous('Person', ''));
+      assert.strictEqual(await db.functionAsync('delay^mock', 1, 'done'), 'done');
+
+      await person.setAsync(2, 'Jane Doe');
+      assert.strictEqual(await person.getAsync(2), 'Jane Doe');
+      assert.strictEqual(await person.getAsync(2), person.get(2));
+      assert.strictEqual(await person.definedAsync(2), person.defined(2));
+      assert.strictEqual(await person.nextAsync(1), person.next(1));
+      assert.strictEqual(person.next(1), '2'); // the connection and mglobal objects address the same global
+      assert.strictEqual(await person.previousAsync(2), person.previous(2));
+      const bx = await person.get_bxAsync(2);
+      assert.ok(Buffer.isBuffer(bx));
+      assert.strictEqual(bx.toString(), 'Jane Doe');
+      await person.deleteAsync(2);
+      assert.strictEqual(await person.definedAsync(2), person.defined(2));
+      assert.strictEqual(Number(person.defined(2)), 0);
+      assert.strictEqual(person.get(2), '');
+   }
+   finally {
+      con.close();
+   }
+};
+
+tests['a rejection is an Error carrying its own message'] = async function () {
+   const con = await harness.connect(harness.transports.threads);
+
+   try {
+      const requests = [];
+
+      for (let n = 0; n < 16; n ++) {
+         requests.push(harness.settle((n % 2) ? con.db.functionAsync('error^mock', 'failure ' + n) : con.db.functionAsync('delay^mock', n % 3, 'value ' + n)));
+      }
+      const results = await Promise.all(requests);
+
+      results.forEach((result, n) => assert.deepStrictEqual(result, (n % 2) ? ['error', 'failure ' + n] : ['ok', 'value ' + n]));
+
+      await assert.rejects(con.db.functionAsync('error^mock', 'boom'), (error) => error instanceof Error && error.message === 'boom');
+   }
+   finally {
+      con.close();
+   }
+};
+
+tests['the callback and Promise forms agree'] = async function () {
+   const con = await harness.connect(harness.transports.threads);
+
+   try {
+      con.db.set('Person', 1, 'John Smith');
+
+      const [error, result] = await harness.callback(con.db, 'get', 'Person', 1);
+      assert.ok(!error);
+      assert.strictEqual(result, await con.db.getAsync('Person', 1));
+   }
+   finally {
+      con.close();
+   }
+};
+
+// request blocks are recycled: a steady stream of awaited requests does not allocate
+tests['awaited requests reuse their request blocks'] = async function () {
+   const con = await harness.connect(harness.transports.threads);
+
+   try {
+      const person = new harness.dbx.mglobal(con.db, 'Person');
+      const allocs = () => con.db.memstats().allocator.tags.request.allocs;
+
+      person.set(1, 'John Smith');
+      for (let n = 0; n < 100; n ++) {
+         await person.getAsync(1);
+      }
+      const before = allocs();
+      for (let n = 0; n < 2000; n ++) {
+         assert.strictEqual(await person.getAsync(1), 'John Smith');
+      }
+      assert.strictEqual(allocs(), before);
+   }
+   finally {
+      con.close();
+   }
+};
+
+module.exports = tests;
@@ -47,12 +47,13 @@ a0 d vers q
  ; v3.4.12:  10 August    2020 (Introduce streamed write for mg_web; export the data-types for the SQL interface)
  ; v3.5.13:  29 August    2020 (Introduce ASCII streamed write for mg_web; Introduce websocket support; reset ISC namespace after each web request)
  ; v3.5.14:  24 September 2020 (Add a getdatetime() function)
+ ; v3.5.15:  17 October   2026 (Add revision 2 of the mg-dbx protocol: responses carry the ID of the request so that requests may be pipelined)
  ;
 v() ; version and date
  n v,r,d
  s v="3.5"
- s r=14
- s d="24 September 2020"
+ s r=15
+ s d="17 October 2026"
  q v_"."_r_"."_d
  ;
 vers ; version information
@@ -1503,20 +1504,22 @@ dbxe ; Error
  q -1
  ;
 dbxnet(buf) ; new wire protocol for access to M
- n %oref,abyref,argc,array,cmnd,conc,dakey,darec,ddata,deod,extra,global,i,maxlen,mqinfo,nato,offset,ok,oref,oversize,pcmnd,port,pport,rdxbuf,rdxptr,rdxrlen,rdxsize,req,res,sl,slen,sn,sort,type,uci,var,version,x
+ n %oref,abyref,argc,array,cmnd,conc,dakey,darec,ddata,deod,extra,global,i,maxlen,mqinfo,nato,offset,ok,oref,oversize,pcmnd,port,pport,rdxbuf,rdxptr,rdxrlen,rdxsize,req,res,rev,sl,slen,sn,sort,type,uci,var,version,x
  s uci=$p(buf,"~",2)
  i uci'="" d uci(uci)
+ s rev=$s($p(buf,"~",3)=2:2,1:1) ; revision 2: each response is preceded by the ID of its request
  s res=$zv
- s res=$$esize256($l(res))_"0"_res
+ s res=$$esize256($l(res))_$s(rev=2:"2",1:"0")_res
  w res d flush
 dbxnet1 ; test
  r head#5
  s len=$$dsize256(head)
  s len=len-5
  s cmnd=$e(head,5)
- i len>$$getmsl() s res="DB Server string size exceeded ("_$$getmsl()_")",sort=11,type=1,res=$$esize256($l(res))_$c((sort*20)+type)_res w res d flush c $io h
+ i len>$$getmsl() s res="DB Server string size exceeded ("_$$getmsl()_")",sort=11,type=1,res=$$esize256($l(res))_$c((sort*20)+type)_res s:rev=2 res=$$esize256(0)_res w res d flush c $io h
  r data#len
  s res=$$dbx(0,cmnd,data,len,"")
+ i rev=2 s res=$e(data,6,9)_res
  w res d flush
  g dbxnet1
  ;